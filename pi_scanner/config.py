@@ -30,6 +30,10 @@ SERVO_MIN_ANGLE = 0      # Minimum angle in degrees
 SERVO_MAX_ANGLE = 180    # Maximum angle in degrees
 SERVO_STEP_DELAY = 0.05  # Delay between servo steps (seconds)
 SERVO_SETTLE_TIME = 0.03 # Time to let servo settle before TOF reading
+SERVO_UPDATE_INTERVAL = 0.02  # PWM target update period during continuous sweeps (seconds)
+SERVO_TRACKING_LAG = 0.0      # Time the servo horn trails its command (seconds, calibrate)
+SERVO_COMMAND_LATENCY = 0.02  # Time before a new command moves the horn (one 50 Hz PWM frame)
+SERVO_TRAVEL_TIME = 0.002     # Seconds per degree of travel (SG90: about 0.1 s per 60 degrees)
 
 # Servo PWM parameters (for gpiozero)
 SERVO_MIN_PULSE_WIDTH = 0.0005  # 0.5ms
@@ -51,6 +55,44 @@ TOF_I2C_ADDRESS = 0x29      # Default I2C address
 TOF_TIMING_BUDGET = 50000   # Timing budget in microseconds (50ms)
 TOF_MAX_RANGE = 4000        # Maximum valid range in mm
 TOF_MIN_RANGE = 10          # Minimum valid range in mm
+TOF_INTER_MEASUREMENT = None  # Period of continuous ranging in ms (None: the
+                              # timing budget + 4 ms, the shortest allowed)
+
+# Data-ready interrupt: with a sensor's GPIO1 wired to a GPIO ('gpio1_pin'
+# in TOF_SENSORS), each result is signalled by an edge and read in one
+# burst I2C transfer, instead of the driver polling the sensor
+TOF_INTERRUPT_ACTIVE_HIGH = True  # GPIO1 polarity (the sensor's default)
+
+# Sensors on the servo arm, the main one first. Every VL53L1X starts at
+# TOF_I2C_ADDRESS, so with more than one the XSHUT pins (BCM) must be
+# wired: the sensors are held in reset at boot, released one at a time
+# and each moved to its own address. Only the first may leave XSHUT
+# unwired, and then needs an address of its own. The offsets point an
+# extra sensor's beam away from the main one along the servo (theta) and
+# stepper (phi) axes, in degrees.
+TOF_SENSORS = [
+    {'xshut_pin': None, 'address': TOF_I2C_ADDRESS, 'gpio1_pin': None},
+]
+# e.g. three sensors 45 degrees apart along the arm:
+# TOF_SENSORS = [
+#     {'xshut_pin': 4, 'address': 0x30, 'gpio1_pin': 12},
+#     {'xshut_pin': 22, 'address': 0x31, 'gpio1_pin': 16, 'theta_offset': 45.0, 'phi_offset': 0.0},
+#     {'xshut_pin': 27, 'address': 0x32, 'gpio1_pin': 20, 'theta_offset': 90.0, 'phi_offset': 0.0},
+# ]
+
+# Sub-field scanning: the VL53L1X can range on a region of interest (ROI)
+# of its 16x16 SPAD array, which steers the beam inside its field of view.
+# At every pose the main sensor then ranges once per ROI of a grid around
+# the centre, and each reading is placed at the direction of its ROI.
+TOF_ROI_SCAN = False
+TOF_ROI_GRID = 3            # ROI centres per axis (3 x 3 readings per pose)
+TOF_ROI_SIZE = 4            # ROI width and height in SPADs (4-16)
+TOF_ROI_SPACING = 4         # SPADs between neighbouring ROI centres
+# Beam steering per SPAD of ROI shift along the servo's motion (the SPAD
+# array's y axis) and the stepper's (x axis), in degrees: the 27 degree
+# field of view over 16 SPADs, negative as the lens inverts the image.
+# Flip a sign if the sensor is mounted mirrored.
+TOF_ROI_STEER = (-27.0 / 16, -27.0 / 16)
 
 # =============================================================================
 # Scan Parameters
@@ -60,10 +102,32 @@ TOF_MIN_RANGE = 10          # Minimum valid range in mm
 SCAN_SERVO_START = 0    # Starting servo angle
 SCAN_SERVO_END = 180    # Ending servo angle
 SCAN_STEPPER_TOTAL = 360  # Total stepper rotation
+SCAN_PATTERN = 'raster'      # 'raster': sweep 0-180-0 at every stepper angle
+                             # 'serpentine': step at each end, so the forward and
+                             # reverse sweeps cover consecutive stepper angles
+                             # 'spiral': a stepper pass at every servo angle
+                             # 'progressive': serpentine sweeps at coarse-to-fine
+                             # stepper angles (0, 180, 90, 270, 45, ...)
 
 # Timing
 SCAN_DELAY_AT_ENDS = 0.5  # Pause at 0 and 180 degrees (seconds)
 
+# Continuous sweep: move the servo at constant velocity while the sensor
+# ranges back to back, instead of stop-settle-read at every degree
+SCAN_CONTINUOUS = False
+SCAN_SWEEP_VELOCITY = None  # Degrees per second; None = one reading per degree
+                            # at the measured ranging rate
+
+# Stepped sweeps: overlap sensor integration with servo motion. The sensor
+# ranges continuously and the next angle is commanded just before each
+# reading is latched, so settling happens between rangings
+SCAN_PIPELINED = False
+
+# Adaptive scans: survey at the plan's coarse steps, then rescan at the fine
+# step only where the relative change of depth gradient exceeds the threshold
+ADAPTIVE_REFINE_STEP = 1.0        # Fine step in degrees
+ADAPTIVE_REFINE_THRESHOLD = 0.1   # Second difference of range / range
+
 # =============================================================================
 # Web Server Configuration
 # =============================================================================
@@ -82,3 +146,48 @@ WEBSOCKET_BATCH_INTERVAL = 0.1  # Max time between batches (seconds)
 
 EXPORT_DIRECTORY = 'scans'  # Directory for exported files
 EXPORT_TIMESTAMP_FORMAT = '%Y%m%d_%H%M%S'  # Timestamp format for filenames
+
+# =============================================================================
+# Point Cloud Storage
+# =============================================================================
+
+POINT_CLOUD_MAX_POINTS = 100000  # Points kept in RAM (the hot window when spilling)
+POINT_CLOUD_SPILL = False        # Also append all points to memory-mapped files
+                                 # under EXPORT_DIRECTORY, so nothing is dropped
+
+# =============================================================================
+# Scan Journal
+# =============================================================================
+
+SCAN_JOURNAL = False         # Journal scans so an interrupted one can resume
+SCAN_JOURNAL_FILE = 'scan.journal'  # Journal file under EXPORT_DIRECTORY
+SCAN_JOURNAL_SYNC_ROWS = 10  # fsync the journal after this many completed rows
+SCAN_JOURNAL_SYNC_INTERVAL = 5.0  # ...or this many seconds, whichever is first
+
+# =============================================================================
+# Simulation
+# =============================================================================
+
+SIMULATION_SCENE = 'room'  # 'room': furnished box room around the scanner
+                           # 'empty_room': the room without furniture
+                           # 'sphere': fixed distance in every direction
+                           # or the path of a PLY mesh (mm, scanner at origin)
+SIMULATION_SEED = None     # Seed of the simulated sensor noise (None = random)
+
+# Simulated VL53L1X noise. Sigma grows with distance^2 / reflectivity, as
+# the returned signal falls; readings drop out towards the range limit,
+# which shrinks with the square root of the target's reflectivity
+TOF_SIM_SIGMA_MIN = 1.5    # Noise floor (mm, one sigma)
+TOF_SIM_SIGMA_1M = 2.5     # Extra sigma at 1 m on a white (88%) target (mm)
+TOF_SIM_DROPOUT = 0.002    # Fraction of readings lost regardless of signal
+
+# =============================================================================
+# Acquisition Recording
+# =============================================================================
+
+ACQUISITION_RECORD = False  # Journal the raw acquisition events of every scan
+                            # to EXPORT_DIRECTORY/acquisition_<timestamp>.acq
+REPLAY_MAX_GAP = 1.0        # Longest recorded gap between readings a replay
+                            # waits out (s); longer gaps (pauses) are shortened
+REPLAY_ANGLE_TOLERANCE = 0.5  # Servo angle difference (degrees) from the
+                              # recording at which a replayed reading diverges
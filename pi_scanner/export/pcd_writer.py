@@ -7,8 +7,9 @@ import logging
 from typing import Optional
 from pathlib import Path
 from datetime import datetime
+import numpy as np
 
-from ..scanner.point_cloud import PointCloud
+from ..scanner.point_cloud import PointCloud, CloudSnapshot
 
 logger = logging.getLogger(__name__)
 
@@ -33,7 +34,7 @@ class PCDWriter:
         Write point cloud to a PCD file.
         
         Args:
-            point_cloud: PointCloud object containing the points
+            point_cloud: PointCloud or CloudSnapshot containing the points
             filepath: Output file path
             include_intensity: If True, include intensity field (uses distance as proxy)
             
@@ -41,9 +42,10 @@ class PCDWriter:
             True if write successful, False otherwise
         """
         try:
-            points = point_cloud.get_points()
+            snapshot = point_cloud.snapshot()
+            count = snapshot.get_point_count()
             
-            if not points:
+            if count == 0:
                 logger.warning("No points to export")
                 return False
             
@@ -67,22 +69,24 @@ class PCDWriter:
                     f.write("TYPE F F F\n")
                     f.write("COUNT 1 1 1\n")
                 
-                f.write(f"WIDTH {len(points)}\n")
+                f.write(f"WIDTH {count}\n")
                 f.write("HEIGHT 1\n")
                 f.write("VIEWPOINT 0 0 0 1 0 0 0\n")
-                f.write(f"POINTS {len(points)}\n")
+                f.write(f"POINTS {count}\n")
                 f.write("DATA ascii\n")
                 
-                # Write point data
-                for point in points:
-                    if include_intensity:
+                # Write point data a slice at a time
+                if include_intensity:
+                    for columns in snapshot.iter_columns(('xyz', 'distance')):
                         # Use distance as intensity proxy (normalized)
-                        intensity = point.distance / 4000.0  # Normalize to ~0-1
-                        f.write(f"{point.x:.6f} {point.y:.6f} {point.z:.6f} {intensity:.4f}\n")
-                    else:
-                        f.write(f"{point.x:.6f} {point.y:.6f} {point.z:.6f}\n")
+                        intensity = columns['distance'] / 4000.0  # Normalize to ~0-1
+                        data = np.column_stack((columns['xyz'], intensity))
+                        np.savetxt(f, data, fmt=['%.6f'] * 3 + ['%.4f'])
+                else:
+                    for columns in snapshot.iter_columns(('xyz',)):
+                        np.savetxt(f, columns['xyz'], fmt='%.6f')
             
-            logger.info(f"Exported {len(points)} points to PCD: {filepath}")
+            logger.info(f"Exported {count} points to PCD: {filepath}")
             return True
             
         except Exception as e:
@@ -95,7 +99,7 @@ class PCDWriter:
         Write point cloud to PCD with RGB colors.
         
         Args:
-            point_cloud: PointCloud object containing the points
+            point_cloud: PointCloud or CloudSnapshot containing the points
             filepath: Output file path
             color_by_height: If True, color points based on Z height
             
@@ -103,17 +107,15 @@ class PCDWriter:
             True if write successful, False otherwise
         """
         try:
-            points = point_cloud.get_points()
+            snapshot = point_cloud.snapshot()
+            count = snapshot.get_point_count()
             
-            if not points:
+            if count == 0:
                 logger.warning("No points to export")
                 return False
             
-            # Calculate height range for coloring
-            if color_by_height and points:
-                z_values = [p.z for p in points]
-                z_min, z_max = min(z_values), max(z_values)
-                z_range = z_max - z_min if z_max != z_min else 1
+            # Height range comes from the same snapshot's statistics
+            stats = snapshot.get_stats()
             
             # Ensure directory exists
             Path(filepath).parent.mkdir(parents=True, exist_ok=True)
@@ -127,25 +129,28 @@ class PCDWriter:
                 f.write("SIZE 4 4 4 4\n")
                 f.write("TYPE F F F F\n")
                 f.write("COUNT 1 1 1 1\n")
-                f.write(f"WIDTH {len(points)}\n")
+                f.write(f"WIDTH {count}\n")
                 f.write("HEIGHT 1\n")
                 f.write("VIEWPOINT 0 0 0 1 0 0 0\n")
-                f.write(f"POINTS {len(points)}\n")
+                f.write(f"POINTS {count}\n")
                 f.write("DATA ascii\n")
                 
-                # Write point data
-                for point in points:
+                # Write point data a slice at a time
+                for columns in snapshot.iter_columns(('xyz',)):
+                    points = columns['xyz']
                     if color_by_height:
-                        t = (point.z - z_min) / z_range
-                        r, g, b = self._height_to_rgb(t)
+                        colors = self._heights_to_rgb(points[:, 2], stats.min[2], stats.max[2])
                     else:
-                        r, g, b = 255, 255, 255
+                        colors = np.full((len(points), 3), 255, dtype=np.uint8)
                     
                     # Pack RGB into float (PCL convention)
-                    rgb_packed = self._pack_rgb(r, g, b)
-                    f.write(f"{point.x:.6f} {point.y:.6f} {point.z:.6f} {rgb_packed}\n")
+                    colors = colors.astype(np.uint32)
+                    rgb_packed = (colors[:, 0] << 16) | (colors[:, 1] << 8) | colors[:, 2]
+                    
+                    data = np.column_stack((points, rgb_packed))
+                    np.savetxt(f, data, fmt=['%.6f'] * 3 + ['%.1f'])
             
-            logger.info(f"Exported {len(points)} colored points to PCD: {filepath}")
+            logger.info(f"Exported {count} colored points to PCD: {filepath}")
             return True
             
         except Exception as e:
@@ -158,7 +163,7 @@ class PCDWriter:
         Write point cloud as organized (2D grid) PCD.
         
         Args:
-            point_cloud: PointCloud object containing the points
+            point_cloud: PointCloud or CloudSnapshot containing the points
             filepath: Output file path
             width: Width of the organized point cloud (e.g., 360 for stepper angles)
             height: Height of the organized point cloud (e.g., 181 for servo angles)
@@ -167,18 +172,20 @@ class PCDWriter:
             True if write successful, False otherwise
         """
         try:
-            points = point_cloud.get_points()
-            
-            if not points:
+            snapshot = point_cloud.snapshot()
+            if snapshot.get_point_count() == 0:
                 logger.warning("No points to export")
                 return False
             
             # Ensure directory exists
             Path(filepath).parent.mkdir(parents=True, exist_ok=True)
             
-            # Create organized grid (fill with NaN for missing points)
-            import math
-            nan = float('nan')
+            range_image = getattr(point_cloud, 'range_image', None)
+            if range_image is not None and range_image.shape == (height, width):
+                # Organized store already holds the grid (NaN for missing points)
+                grid = range_image.to_cartesian()
+            else:
+                grid = self._grid_from_columns(snapshot, width, height)
             
             with open(filepath, 'w') as f:
                 # PCD Header for organized point cloud
@@ -196,21 +203,8 @@ class PCDWriter:
                 f.write(f"POINTS {width * height}\n")
                 f.write("DATA ascii\n")
                 
-                # Create a lookup dictionary for points by angle
-                point_lookup = {}
-                for p in points:
-                    key = (int(p.phi), int(p.theta))
-                    point_lookup[key] = p
-                
                 # Write organized grid
-                for servo_angle in range(height):  # theta (rows)
-                    for stepper_angle in range(width):  # phi (columns)
-                        key = (stepper_angle, servo_angle)
-                        if key in point_lookup:
-                            p = point_lookup[key]
-                            f.write(f"{p.x:.6f} {p.y:.6f} {p.z:.6f}\n")
-                        else:
-                            f.write(f"{nan} {nan} {nan}\n")
+                np.savetxt(f, grid.reshape(-1, 3), fmt='%.6f')
             
             logger.info(f"Exported organized {width}x{height} point cloud to PCD: {filepath}")
             return True
@@ -219,6 +213,49 @@ class PCDWriter:
             logger.error(f"Failed to write organized PCD file: {e}")
             return False
     
+    def _grid_from_columns(self, snapshot: CloudSnapshot,
+                           width: int, height: int) -> np.ndarray:
+        """
+        Build an organized grid from the point columns by integer angle.
+        
+        Args:
+            snapshot: Snapshot of the points
+            width: Number of stepper angle columns
+            height: Number of servo angle rows
+            
+        Returns:
+            Float32 array of shape (height, width, 3); NaN for missing points
+        """
+        grid = np.full((height, width, 3), np.nan, dtype=np.float32)
+        # Slices come oldest first, so later points overwrite earlier ones
+        # at the same cell
+        for columns in snapshot.iter_columns(('xyz', 'theta', 'phi')):
+            rows = columns['theta'].astype(np.int64)  # theta (rows)
+            cols = columns['phi'].astype(np.int64)    # phi (columns)
+            inside = (rows >= 0) & (rows < height) & (cols >= 0) & (cols < width)
+            grid[rows[inside], cols[inside]] = columns['xyz'][inside]
+        return grid
+    
+    def _heights_to_rgb(self, z: np.ndarray, z_min: float, z_max: float) -> np.ndarray:
+        """
+        Convert an array of heights to RGB colors (vectorized _height_to_rgb).
+        
+        Args:
+            z: Array of Z values
+            z_min, z_max: Height range mapped onto the gradient
+            
+        Returns:
+            Array of shape (N, 3) with uint8 RGB values
+        """
+        z_range = z_max - z_min if z_max != z_min else 1
+        t = np.clip((z.astype(np.float64) - z_min) / z_range, 0, 1)
+        
+        r = np.select([t < 0.5, t < 0.75], [0, (t - 0.5) * 4], 1)
+        g = np.select([t < 0.25, t < 0.75], [t * 4, 1], 1 - (t - 0.75) * 4)
+        b = np.select([t < 0.25, t < 0.5], [1, 1 - (t - 0.25) * 4], 0)
+        
+        return (np.column_stack((r, g, b)) * 255).astype(np.uint8)
+    
     def _height_to_rgb(self, t: float) -> tuple:
         """
         Convert normalized height (0-1) to RGB color.
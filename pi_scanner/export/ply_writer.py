@@ -6,6 +6,7 @@ Exports to ASCII PLY format compatible with MeshLab, Blender, CloudCompare, etc.
 import logging
 from typing import Optional
 from pathlib import Path
+import numpy as np
 
 from ..scanner.point_cloud import PointCloud
 
@@ -34,7 +35,7 @@ class PLYWriter:
         Write point cloud to a PLY file.
         
         Args:
-            point_cloud: PointCloud object containing the points
+            point_cloud: PointCloud or CloudSnapshot containing the points
             filepath: Output file path
             include_original_coords: If True, include theta, phi, distance as properties
             
@@ -42,9 +43,10 @@ class PLYWriter:
             True if write successful, False otherwise
         """
         try:
-            points = point_cloud.get_points()
+            snapshot = point_cloud.snapshot()
+            count = snapshot.get_point_count()
             
-            if not points:
+            if count == 0:
                 logger.warning("No points to export")
                 return False
             
@@ -56,7 +58,7 @@ class PLYWriter:
                 f.write("ply\n")
                 f.write("format ascii 1.0\n")
                 f.write(f"comment Generated by 3D Spatial Eye Scanner\n")
-                f.write(f"element vertex {len(points)}\n")
+                f.write(f"element vertex {count}\n")
                 f.write("property float x\n")
                 f.write("property float y\n")
                 f.write("property float z\n")
@@ -68,15 +70,17 @@ class PLYWriter:
                 
                 f.write("end_header\n")
                 
-                # Write point data
-                for point in points:
-                    if include_original_coords:
-                        f.write(f"{point.x:.6f} {point.y:.6f} {point.z:.6f} "
-                               f"{point.theta:.2f} {point.phi:.2f} {point.distance:.2f}\n")
-                    else:
-                        f.write(f"{point.x:.6f} {point.y:.6f} {point.z:.6f}\n")
+                # Write point data a slice at a time
+                if include_original_coords:
+                    for columns in snapshot.iter_columns(('xyz', 'theta', 'phi', 'distance')):
+                        data = np.column_stack((columns['xyz'], columns['theta'],
+                                                columns['phi'], columns['distance']))
+                        np.savetxt(f, data, fmt=['%.6f'] * 3 + ['%.2f'] * 3)
+                else:
+                    for columns in snapshot.iter_columns(('xyz',)):
+                        np.savetxt(f, columns['xyz'], fmt='%.6f')
             
-            logger.info(f"Exported {len(points)} points to PLY: {filepath}")
+            logger.info(f"Exported {count} points to PLY: {filepath}")
             return True
             
         except Exception as e:
@@ -89,7 +93,7 @@ class PLYWriter:
         Write point cloud to PLY with RGB colors.
         
         Args:
-            point_cloud: PointCloud object containing the points
+            point_cloud: PointCloud or CloudSnapshot containing the points
             filepath: Output file path
             color_by_height: If True, color points based on Z height
             
@@ -97,17 +101,15 @@ class PLYWriter:
             True if write successful, False otherwise
         """
         try:
-            points = point_cloud.get_points()
+            snapshot = point_cloud.snapshot()
+            count = snapshot.get_point_count()
             
-            if not points:
+            if count == 0:
                 logger.warning("No points to export")
                 return False
             
-            # Calculate height range for coloring
-            if color_by_height and points:
-                z_values = [p.z for p in points]
-                z_min, z_max = min(z_values), max(z_values)
-                z_range = z_max - z_min if z_max != z_min else 1
+            # Height range comes from the same snapshot's statistics
+            stats = snapshot.get_stats()
             
             # Ensure directory exists
             Path(filepath).parent.mkdir(parents=True, exist_ok=True)
@@ -117,7 +119,7 @@ class PLYWriter:
                 f.write("ply\n")
                 f.write("format ascii 1.0\n")
                 f.write(f"comment Generated by 3D Spatial Eye Scanner\n")
-                f.write(f"element vertex {len(points)}\n")
+                f.write(f"element vertex {count}\n")
                 f.write("property float x\n")
                 f.write("property float y\n")
                 f.write("property float z\n")
@@ -126,25 +128,45 @@ class PLYWriter:
                 f.write("property uchar blue\n")
                 f.write("end_header\n")
                 
-                # Write point data
-                for point in points:
+                # Write point data a slice at a time
+                for columns in snapshot.iter_columns(('xyz',)):
+                    points = columns['xyz']
                     if color_by_height:
-                        # Color based on normalized height
-                        t = (point.z - z_min) / z_range
-                        r, g, b = self._height_to_rgb(t)
+                        colors = self._heights_to_rgb(points[:, 2], stats.min[2], stats.max[2])
                     else:
                         # Default white
-                        r, g, b = 255, 255, 255
-                    
-                    f.write(f"{point.x:.6f} {point.y:.6f} {point.z:.6f} {r} {g} {b}\n")
+                        colors = np.full((len(points), 3), 255, dtype=np.uint8)
+                    data = np.column_stack((points, colors))
+                    np.savetxt(f, data, fmt=['%.6f'] * 3 + ['%d'] * 3)
             
-            logger.info(f"Exported {len(points)} colored points to PLY: {filepath}")
+            logger.info(f"Exported {count} colored points to PLY: {filepath}")
             return True
             
         except Exception as e:
             logger.error(f"Failed to write PLY file with colors: {e}")
             return False
     
+    def _heights_to_rgb(self, z: np.ndarray, z_min: float, z_max: float) -> np.ndarray:
+        """
+        Convert an array of heights to RGB colors (vectorized _height_to_rgb).
+        
+        Args:
+            z: Array of Z values
+            z_min, z_max: Height range mapped onto the gradient
+            
+        Returns:
+            Array of shape (N, 3) with uint8 RGB values
+        """
+        z_range = z_max - z_min if z_max != z_min else 1
+        t = np.clip((z.astype(np.float64) - z_min) / z_range, 0, 1)
+        
+        # Same blue-cyan-green-yellow-red gradient as _height_to_rgb
+        r = np.select([t < 0.5, t < 0.75], [0, (t - 0.5) * 4], 1)
+        g = np.select([t < 0.25, t < 0.75], [t * 4, 1], 1 - (t - 0.75) * 4)
+        b = np.select([t < 0.25, t < 0.5], [1, 1 - (t - 0.25) * 4], 0)
+        
+        return (np.column_stack((r, g, b)) * 255).astype(np.uint8)
+    
     def _height_to_rgb(self, t: float) -> tuple:
         """
         Convert normalized height (0-1) to RGB color.
@@ -2,8 +2,16 @@
 Hardware interface modules for TOF sensor, servo, and stepper motor.
 """
 
+from .clock import Clock, VirtualClock, SYSTEM_CLOCK
 from .tof_sensor import TOFSensor
+from .tof_array import TOFSensorArray
+from .tof_roi import SubField, FULL_FIELD, sub_field_grid, steer_angles
 from .servo import ServoController
 from .stepper import StepperMotor
+from .acquisition_log import AcquisitionEvent, AcquisitionRecorder, AcquisitionLog
+from .replay import ReplayTOFSensor, ReplayServoController, ReplayStepperMotor
 
-__all__ = ['TOFSensor', 'ServoController', 'StepperMotor']
+__all__ = ['Clock', 'VirtualClock', 'SYSTEM_CLOCK', 'TOFSensor', 'TOFSensorArray', 'ServoController', 'StepperMotor',
+           'SubField', 'FULL_FIELD', 'sub_field_grid', 'steer_angles',
+           'AcquisitionEvent', 'AcquisitionRecorder', 'AcquisitionLog',
+           'ReplayTOFSensor', 'ReplayServoController', 'ReplayStepperMotor']
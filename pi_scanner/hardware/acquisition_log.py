@@ -0,0 +1,166 @@
+"""
+Binary journal of raw acquisition events.
+
+A recording holds every TOF ranging of a scan with the commanded position
+of the mechanism at that moment, so a session captured on site can be fed
+back through the whole pipeline later (see replay.py).
+
+File layout:
+- 8-byte magic b'SEYEACQ1'
+- u32 length, then a UTF-8 JSON header (scan plan, sweep mode, sensor
+  timing of the session)
+- fixed-size little-endian records of RECORD_FORMAT, one per ranging
+"""
+
+import json
+import logging
+import os
+import struct
+import threading
+from dataclasses import dataclass
+from datetime import datetime
+from typing import List, Optional
+
+from ..config import EXPORT_DIRECTORY, EXPORT_TIMESTAMP_FORMAT
+
+logger = logging.getLogger(__name__)
+
+ACQUISITION_MAGIC = b'SEYEACQ1'
+
+# Clock time the reading was latched (s), commanded servo angle (degrees),
+# stepper position (steps), raw range (mm), ranging status
+RECORD_FORMAT = struct.Struct('<dfiHB')
+
+# File extension of recordings
+ACQUISITION_EXTENSION = 'acq'
+
+# Buffer size of the recording file; a power failure loses at most this much
+RECORD_BUFFER = 64 * 1024
+
+
+@dataclass
+class AcquisitionEvent:
+    """One raw ranging and the commanded position of the mechanism."""
+    timestamp: float     # Clock time the reading was latched
+    servo_angle: float   # Commanded servo angle in degrees
+    stepper_steps: int   # Stepper position in steps from 0 degrees
+    distance: int        # Raw range in mm (0 if the ranging failed)
+    status: int          # Ranging status (tof_sensor.RANGE_STATUS_*)
+
+
+class AcquisitionRecorder:
+    """
+    Append-only writer of a recording.
+    
+    record() is called from the thread that reads the sensor; records are
+    packed into a buffered file and written out in blocks.
+    """
+    
+    def __init__(self, metadata: dict, filepath: Optional[str] = None,
+                 directory: str = EXPORT_DIRECTORY):
+        """
+        Create the recording and write its header.
+        
+        Args:
+            metadata: Session description stored in the header (JSON-serializable)
+            filepath: Path of the recording (default: a timestamped file in directory)
+            directory: Directory of timestamped recordings (created if needed)
+        
+        Raises:
+            OSError: If the file cannot be created
+        """
+        if filepath is None:
+            os.makedirs(directory, exist_ok=True)
+            timestamp = datetime.now().strftime(EXPORT_TIMESTAMP_FORMAT)
+            filepath = os.path.join(directory, f"acquisition_{timestamp}.{ACQUISITION_EXTENSION}")
+        
+        self.filepath = filepath
+        self.count = 0
+        self._lock = threading.Lock()
+        self._file = open(filepath, 'wb', buffering=RECORD_BUFFER)
+        
+        header = json.dumps(metadata).encode('utf-8')
+        self._file.write(ACQUISITION_MAGIC)
+        self._file.write(struct.pack('<I', len(header)))
+        self._file.write(header)
+        logger.info(f"Recording acquisition to {filepath}")
+    
+    def record(self, event: AcquisitionEvent):
+        """Append one event."""
+        packed = RECORD_FORMAT.pack(
+            event.timestamp,
+            event.servo_angle,
+            event.stepper_steps,
+            max(0, min(0xFFFF, int(event.distance))),
+            event.status
+        )
+        with self._lock:
+            if self._file is None:
+                return
+            self._file.write(packed)
+            self.count += 1
+    
+    def close(self):
+        """Write out buffered events and close the file."""
+        with self._lock:
+            if self._file is None:
+                return
+            try:
+                self._file.close()
+            except OSError as e:
+                logger.error(f"Failed to close acquisition recording: {e}")
+            self._file = None
+        logger.info(f"Recorded {self.count} acquisition events to {self.filepath}")
+
+
+class AcquisitionLog:
+    """A loaded recording: the session metadata and its events in order."""
+    
+    def __init__(self, metadata: dict, events: List[AcquisitionEvent]):
+        """
+        Args:
+            metadata: Session description from the header
+            events: Recorded events in order
+        """
+        self.metadata = metadata
+        self.events = events
+    
+    def __len__(self) -> int:
+        return len(self.events)
+    
+    @property
+    def duration(self) -> float:
+        """Get the clock time from the first to the last event in seconds."""
+        if not self.events:
+            return 0.0
+        return self.events[-1].timestamp - self.events[0].timestamp
+    
+    @classmethod
+    def load(cls, filepath: str) -> 'AcquisitionLog':
+        """
+        Read a recording.
+        
+        A truncated last record (e.g. after a power failure) is ignored.
+        
+        Args:
+            filepath: Path of the recording
+        
+        Returns:
+            The recording
+        
+        Raises:
+            OSError: If the file cannot be read
+            ValueError: If the file is not a recording
+        """
+        with open(filepath, 'rb') as f:
+            if f.read(len(ACQUISITION_MAGIC)) != ACQUISITION_MAGIC:
+                raise ValueError(f"Not an acquisition recording: {filepath}")
+            (length,) = struct.unpack('<I', f.read(4))
+            metadata = json.loads(f.read(length).decode('utf-8'))
+            body = f.read()
+        
+        usable = len(body) - len(body) % RECORD_FORMAT.size
+        events = [AcquisitionEvent(*fields)
+                  for fields in RECORD_FORMAT.iter_unpack(body[:usable])]
+        logger.info(f"Loaded {len(events)} acquisition events from {filepath}")
+        return cls(metadata, events)
@@ -0,0 +1,318 @@
+"""
+Time source shared by the hardware drivers and the scan coordinator.
+
+Everything that reads the time, sleeps or blocks with a timeout goes through
+a Clock. The default uses the system monotonic clock and the threading
+primitives. VirtualClock keeps its own time instead, which only moves
+forward when every thread it runs is waiting, and then jumps straight to
+the earliest deadline: a simulated scan takes the same (virtual) time it
+would on hardware, but completes as fast as the CPU allows.
+"""
+
+import itertools
+import logging
+import queue
+import threading
+import time
+from collections import deque
+from typing import Callable, Dict, Optional
+
+logger = logging.getLogger(__name__)
+
+
+class Clock:
+    """System time and blocking primitives."""
+    
+    # Simulated hardware may run faster than real time on the system clock;
+    # on a virtual clock waiting is free, so it keeps the hardware timing
+    virtual = False
+    
+    def monotonic(self) -> float:
+        """Get the current time in seconds (time.monotonic())."""
+        return time.monotonic()
+    
+    def sleep(self, seconds: float):
+        """Block the calling thread for a number of seconds."""
+        if seconds > 0:
+            time.sleep(seconds)
+    
+    def condition(self) -> threading.Condition:
+        """Create a condition variable (re-entrant lock)."""
+        return threading.Condition(threading.RLock())
+    
+    def event(self) -> threading.Event:
+        """Create an event."""
+        return threading.Event()
+    
+    def queue(self) -> queue.Queue:
+        """Create an unbounded FIFO queue."""
+        return queue.Queue()
+    
+    def start_thread(self, target: Callable[[], None], name: Optional[str] = None) -> threading.Thread:
+        """
+        Start a daemon thread.
+        
+        Args:
+            target: Function the thread runs
+            name: Thread name
+        
+        Returns:
+            The started thread
+        """
+        thread = threading.Thread(target=target, name=name, daemon=True)
+        thread.start()
+        return thread
+
+
+# Default clock of all components
+SYSTEM_CLOCK = Clock()
+
+
+class VirtualClock(Clock):
+    """
+    Discrete-event clock for simulation.
+    
+    Threads started with start_thread() run under the clock. Time stands
+    still while any of them is running and advances to the earliest
+    deadline once all of them are blocked in a sleep or in a wait on one of
+    the clock's primitives. Those primitives share one lock, so a signal
+    and the wake-up it causes are seen together and time never advances
+    past a thread that is about to run.
+    
+    Other threads (e.g. the web server) may use the primitives too; they
+    take part in the clock only while they are blocked in a wait.
+    """
+    
+    virtual = True
+    
+    def __init__(self, start: float = 0.0):
+        """
+        Initialize the clock.
+        
+        Args:
+            start: Initial time in seconds
+        """
+        self._lock = threading.Condition(threading.RLock())
+        self._now = start
+        self._participants = 0   # Threads whose progress holds time back
+        self._blocked = 0        # Participants waiting since the last wake-up
+        self._generation = 0     # Incremented on every wake-up
+        self._deadlines: Dict[int, float] = {}  # Waiter -> deadline
+        self._waiter_ids = itertools.count()
+        self._local = threading.local()
+    
+    def monotonic(self) -> float:
+        """Get the virtual time in seconds."""
+        return self._now
+    
+    def sleep(self, seconds: float):
+        """Block the calling thread for a number of virtual seconds."""
+        if seconds <= 0:
+            return
+        with self._lock:
+            self._wait(lambda: False, self._now + seconds)
+    
+    def condition(self) -> '_VirtualCondition':
+        """Create a condition variable on the clock's lock."""
+        return _VirtualCondition(self)
+    
+    def event(self) -> '_VirtualEvent':
+        """Create an event."""
+        return _VirtualEvent(self)
+    
+    def queue(self) -> '_VirtualQueue':
+        """Create an unbounded FIFO queue."""
+        return _VirtualQueue(self)
+    
+    def start_thread(self, target: Callable[[], None], name: Optional[str] = None) -> threading.Thread:
+        """
+        Start a daemon thread that runs under the clock.
+        
+        Args:
+            target: Function the thread runs
+            name: Thread name
+        
+        Returns:
+            The started thread; join() from a clock thread waits in virtual time
+        """
+        thread = _VirtualThread(self, target, name)
+        with self._lock:
+            # Count the thread before it starts, so time waits for it
+            self._participants += 1
+        thread.start()
+        return thread
+    
+    def _is_participant(self) -> bool:
+        """Check if the calling thread runs under the clock."""
+        return getattr(self._local, 'participant', False)
+    
+    def _wake(self):
+        """Wake every waiter to re-check its condition (lock held)."""
+        self._generation += 1
+        self._blocked = 0
+        self._lock.notify_all()
+    
+    def _advance_if_idle(self):
+        """Jump to the earliest deadline once every participant waits (lock held)."""
+        if self._blocked < self._participants or not self._deadlines:
+            return
+        self._now = max(self._now, min(self._deadlines.values()))
+        self._wake()
+    
+    def _wait(self, ready: Callable[[], bool], deadline: Optional[float]) -> bool:
+        """
+        Block until ready() holds or the virtual deadline passes (lock held).
+        
+        Args:
+            ready: Condition to wait for, evaluated under the lock
+            deadline: Virtual time to give up at, or None to wait indefinitely
+        
+        Returns:
+            True if ready() holds, False on timeout
+        """
+        temporary = not self._is_participant()
+        if temporary:
+            self._participants += 1
+        waiter = next(self._waiter_ids)
+        try:
+            while not ready():
+                if deadline is not None:
+                    if self._now >= deadline:
+                        return False
+                    self._deadlines[waiter] = deadline
+                self._blocked += 1
+                generation = self._generation
+                self._advance_if_idle()
+                while self._generation == generation:
+                    self._lock.wait()
+            return True
+        finally:
+            self._deadlines.pop(waiter, None)
+            if temporary:
+                self._participants -= 1
+                self._advance_if_idle()
+    
+    def _thread_finished(self, thread: '_VirtualThread'):
+        """Account for a clock thread that has ended."""
+        with self._lock:
+            thread.finished = True
+            self._participants -= 1
+            self._wake()
+
+
+class _VirtualThread(threading.Thread):
+    """Thread run under a VirtualClock."""
+    
+    def __init__(self, clock: VirtualClock, target: Callable[[], None], name: Optional[str]):
+        super().__init__(name=name, daemon=True)
+        self._clock = clock
+        self._run_target = target
+        self.finished = False
+    
+    def run(self):
+        self._clock._local.participant = True
+        try:
+            self._run_target()
+        except Exception as e:
+            logger.error(f"Error in clock thread {self.name}: {e}")
+        finally:
+            self._clock._thread_finished(self)
+    
+    def join(self, timeout: Optional[float] = None):
+        """Wait for the thread; the timeout is virtual time from a clock thread."""
+        clock = self._clock
+        if not clock._is_participant():
+            super().join(timeout)
+            return
+        with clock._lock:
+            deadline = None if timeout is None else clock._now + timeout
+            clock._wait(lambda: self.finished, deadline)
+
+
+class _VirtualCondition:
+    """Condition variable of a VirtualClock (shares the clock's lock)."""
+    
+    def __init__(self, clock: VirtualClock):
+        self._clock = clock
+        self._notifications = 0
+    
+    def __enter__(self):
+        return self._clock._lock.__enter__()
+    
+    def __exit__(self, *exc):
+        return self._clock._lock.__exit__(*exc)
+    
+    def wait(self, timeout: Optional[float] = None) -> bool:
+        """Wait for a notification or the virtual timeout."""
+        clock = self._clock
+        with clock._lock:
+            seen = self._notifications
+            deadline = None if timeout is None else clock._now + timeout
+            return clock._wait(lambda: self._notifications != seen, deadline)
+    
+    def notify_all(self):
+        """Wake all threads waiting on the condition."""
+        with self._clock._lock:
+            self._notifications += 1
+            self._clock._wake()
+    
+    notify = notify_all
+
+
+class _VirtualEvent:
+    """Event of a VirtualClock."""
+    
+    def __init__(self, clock: VirtualClock):
+        self._clock = clock
+        self._flag = False
+    
+    def is_set(self) -> bool:
+        return self._flag
+    
+    def set(self):
+        with self._clock._lock:
+            self._flag = True
+            self._clock._wake()
+    
+    def clear(self):
+        with self._clock._lock:
+            self._flag = False
+    
+    def wait(self, timeout: Optional[float] = None) -> bool:
+        """Wait until the flag is set or the virtual timeout passes."""
+        clock = self._clock
+        with clock._lock:
+            deadline = None if timeout is None else clock._now + timeout
+            return clock._wait(lambda: self._flag, deadline)
+
+
+class _VirtualQueue:
+    """Unbounded FIFO queue of a VirtualClock (queue.Queue interface subset)."""
+    
+    def __init__(self, clock: VirtualClock):
+        self._clock = clock
+        self._items = deque()
+    
+    def put(self, item):
+        with self._clock._lock:
+            self._items.append(item)
+            self._clock._wake()
+    
+    def get(self, block: bool = True, timeout: Optional[float] = None):
+        """
+        Remove and return the oldest item.
+        
+        Raises:
+            queue.Empty: If no item arrived (within the virtual timeout)
+        """
+        clock = self._clock
+        with clock._lock:
+            if block:
+                deadline = None if timeout is None else clock._now + timeout
+                clock._wait(lambda: bool(self._items), deadline)
+            if not self._items:
+                raise queue.Empty
+            return self._items.popleft()
+    
+    def get_nowait(self):
+        return self.get(block=False)
@@ -0,0 +1,139 @@
+"""
+Replay backends: drivers that play a recorded acquisition session back.
+
+ReplayTOFSensor returns the recorded rangings in order, paced by their
+recorded timestamps; ReplayServoController and ReplayStepperMotor accept
+commands without hardware and take the motors' real motion time. Together
+they run the full scan pipeline on a dev box with the readings (and their
+timing) of a session captured on site. On the system clock a replay runs
+in real time; on a VirtualClock it runs as fast as the CPU allows.
+"""
+
+import logging
+from typing import Callable, Optional, Tuple
+
+from .acquisition_log import AcquisitionLog
+from .clock import Clock, SYSTEM_CLOCK
+from .tof_sensor import TOFSensor, RANGE_STATUS_FAILED
+from .servo import ServoController
+from .stepper import StepperMotor
+from ..config import REPLAY_MAX_GAP, REPLAY_ANGLE_TOLERANCE
+
+logger = logging.getLogger(__name__)
+
+
+class ReplayTOFSensor(TOFSensor):
+    """
+    TOF sensor returning the rangings of a recording.
+    
+    Each ranging is latched the recorded interval after the previous one
+    (gaps longer than REPLAY_MAX_GAP are shortened to it), or later if the
+    scan asks for it later. Once the recording is used up, rangings fail.
+    """
+    
+    def __init__(self, log: AcquisitionLog, clock: Clock = SYSTEM_CLOCK):
+        """
+        Initialize the sensor.
+        
+        Args:
+            log: Recording to play back
+            clock: Time source for the replay
+        """
+        super().__init__(simulate=True, clock=clock)
+        self.log = log
+        integration_time = log.metadata.get('integration_time')
+        if integration_time:
+            self._integration_time = integration_time
+            self._measurement_period = integration_time
+        
+        # Commanded (servo angle, stepper steps) at a clock time, to check
+        # that the replayed scan follows the recorded one
+        self._position: Optional[Callable[[float], Tuple[float, int]]] = None
+        self.rewind()
+    
+    def rewind(self):
+        """Play the recording again from its first ranging."""
+        self._index = 0
+        self._last_latch: Optional[float] = None
+        self.replayed = 0
+        self.diverged = 0
+    
+    def set_position_source(self, position: Callable[[float], Tuple[float, int]]):
+        """
+        Compare the mechanism's position with the recording at every ranging.
+        
+        Args:
+            position: Function from a clock time to the commanded
+                      (servo angle, stepper steps)
+        """
+        self._position = position
+    
+    def initialize(self) -> bool:
+        """
+        Start the replay.
+        
+        Returns:
+            True
+        """
+        logger.info(f"TOF sensor replaying {len(self.log)} recorded rangings "
+                    f"({self.log.duration:.1f}s)")
+        self._initialized = True
+        return True
+    
+    def _range(self) -> Tuple[int, int]:
+        """Return the next recorded ranging at its time."""
+        events = self.log.events
+        if self._index >= len(events):
+            if self._index == len(events):
+                logger.warning("Acquisition recording used up; further rangings fail")
+                self._index += 1
+            self.clock.sleep(self._integration_time)
+            return 0, RANGE_STATUS_FAILED
+        
+        event = events[self._index]
+        now = self.clock.monotonic()
+        if self._last_latch is None:
+            due = now + self._integration_time
+        else:
+            interval = event.timestamp - events[self._index - 1].timestamp
+            due = self._last_latch + min(max(0.0, interval), REPLAY_MAX_GAP)
+        self.clock.sleep(due - now)
+        self._last_latch = max(due, now)
+        self._index += 1
+        self.replayed += 1
+        
+        if self._position is not None:
+            servo_angle, stepper_steps = self._position(self._last_latch)
+            if (abs(servo_angle - event.servo_angle) > REPLAY_ANGLE_TOLERANCE
+                    or stepper_steps != event.stepper_steps):
+                self.diverged += 1
+        
+        return event.distance, event.status
+    
+    def to_dict(self) -> dict:
+        """Convert replay progress to dictionary for JSON serialization."""
+        return {
+            'recorded': len(self.log),
+            'replayed': self.replayed,
+            'diverged': self.diverged
+        }
+
+
+class ReplayServoController(ServoController):
+    """Servo without hardware that takes the real motor's motion time."""
+    
+    def __init__(self, clock: Clock = SYSTEM_CLOCK):
+        super().__init__(simulate=True, clock=clock)
+    
+    def _simulated_time_scale(self) -> float:
+        return 1.0
+
+
+class ReplayStepperMotor(StepperMotor):
+    """Stepper without hardware that takes the real motor's step time."""
+    
+    def __init__(self, clock: Clock = SYSTEM_CLOCK):
+        super().__init__(simulate=True, clock=clock)
+    
+    def _simulated_time_scale(self) -> float:
+        return 1.0
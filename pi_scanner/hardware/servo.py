@@ -3,8 +3,8 @@ Servo motor control for Raspberry Pi using gpiozero/pigpio.
 """
 
 import logging
-import time
-from typing import Optional
+import threading
+from typing import Optional, Tuple
 
 try:
     from gpiozero import Servo
@@ -13,6 +13,7 @@ try:
 except ImportError:
     HAS_GPIOZERO = False
 
+from .clock import Clock, SYSTEM_CLOCK
 from ..config import (
     SERVO_PIN,
     SERVO_MIN_ANGLE,
@@ -20,7 +21,9 @@ from ..config import (
     SERVO_MIN_PULSE_WIDTH,
     SERVO_MAX_PULSE_WIDTH,
     SERVO_STEP_DELAY,
-    SERVO_SETTLE_TIME
+    SERVO_SETTLE_TIME,
+    SERVO_UPDATE_INTERVAL,
+    SERVO_TRACKING_LAG
 )
 
 logger = logging.getLogger(__name__)
@@ -33,21 +36,29 @@ class ServoController:
     Uses gpiozero with pigpio backend for hardware PWM on Raspberry Pi.
     """
     
-    def __init__(self, pin: int = SERVO_PIN, simulate: bool = False):
+    def __init__(self, pin: int = SERVO_PIN, simulate: bool = False,
+                 clock: Clock = SYSTEM_CLOCK):
         """
         Initialize the servo controller.
         
         Args:
             pin: GPIO pin number (BCM)
             simulate: If True, run in simulation mode without real hardware
+            clock: Time source for motion timing
         """
         self.pin = pin
         self.simulate = simulate
+        self.clock = clock
         self._servo = None
         self._current_angle = 0
         self._initialized = False
         self._factory = None
         
+        # Continuous sweep timeline: (start time, start angle, end angle, deg/s)
+        self._trajectory: Optional[Tuple[float, float, float, float]] = None
+        self._sweep_thread: Optional[threading.Thread] = None
+        self._sweep_stop = clock.event()
+        
     def initialize(self) -> bool:
         """
         Initialize the servo motor.
@@ -94,6 +105,10 @@ class ServoController:
             logger.error(f"Failed to initialize servo: {e}")
             return False
     
+    def _simulated_time_scale(self) -> float:
+        """Get the factor on simulated motion times (faster in real-time simulation)."""
+        return 1.0 if self.clock.virtual else 0.1
+    
     def _angle_to_value(self, angle: float) -> float:
         """
         Convert angle (0-180) to gpiozero servo value (-1 to 1).
@@ -134,6 +149,9 @@ class ServoController:
         if not self._initialized:
             logger.warning("Servo not initialized")
             return self._current_angle
+        
+        if self._trajectory is not None:
+            self.stop_sweep()
             
         # Clamp angle to valid range
         target_angle = max(SERVO_MIN_ANGLE, min(SERVO_MAX_ANGLE, angle))
@@ -142,7 +160,7 @@ class ServoController:
             if smooth:
                 # Simulate smooth movement delay
                 steps = abs(target_angle - self._current_angle)
-                time.sleep(steps * SERVO_STEP_DELAY * 0.1)  # Faster in simulation
+                self.clock.sleep(steps * SERVO_STEP_DELAY * self._simulated_time_scale())
             self._current_angle = target_angle
             return target_angle
         
@@ -169,7 +187,7 @@ class ServoController:
         while (step > 0 and current < target_angle) or (step < 0 and current > target_angle):
             current += step
             self._set_angle(current)
-            time.sleep(SERVO_STEP_DELAY)
+            self.clock.sleep(SERVO_STEP_DELAY)
         
         # Ensure we reach exact target
         self._set_angle(target_angle)
@@ -199,13 +217,115 @@ class ServoController:
         
         for angle in angles:
             self.move_to(angle, smooth=False)
-            time.sleep(SERVO_SETTLE_TIME)  # Let servo settle
+            self.clock.sleep(SERVO_SETTLE_TIME)  # Let servo settle
             
             if callback:
                 callback(angle)
             
             yield angle
     
+    def start_sweep(self, start: float, end: float, velocity: float) -> float:
+        """
+        Start moving from start to end at a constant angular velocity.
+        
+        The motion follows a fixed timeline, so the angle at any moment is
+        known from angle_at() without polling. On hardware the PWM target is
+        advanced every SERVO_UPDATE_INTERVAL by a background thread; in
+        simulation only the timeline is kept.
+        
+        Args:
+            start: Starting angle in degrees (the servo should already be there)
+            end: Ending angle in degrees
+            velocity: Angular velocity in degrees per second
+            
+        Returns:
+            Clock time at which the motion started
+        """
+        self.stop_sweep()
+        start = max(SERVO_MIN_ANGLE, min(SERVO_MAX_ANGLE, start))
+        end = max(SERVO_MIN_ANGLE, min(SERVO_MAX_ANGLE, end))
+        
+        started = self.clock.monotonic()
+        self._trajectory = (started, start, end, abs(velocity))
+        
+        if self._servo is not None:
+            self._sweep_stop.clear()
+            self._sweep_thread = self.clock.start_thread(self._run_sweep)
+        return started
+    
+    def _run_sweep(self):
+        """Advance the PWM target along the sweep timeline (background thread)."""
+        trajectory = self._trajectory
+        end_time = self._sweep_end_time(trajectory)
+        while not self._sweep_stop.is_set():
+            now = self.clock.monotonic()
+            self._set_angle(self._trajectory_angle(now, trajectory))
+            if now >= end_time:
+                break
+            self._sweep_stop.wait(SERVO_UPDATE_INTERVAL)
+    
+    @staticmethod
+    def _trajectory_angle(timestamp: float, trajectory: Tuple[float, float, float, float]) -> float:
+        """Get the commanded angle of a sweep timeline at a clock time."""
+        started, start, end, velocity = trajectory
+        travel = max(0.0, timestamp - started) * velocity
+        if end >= start:
+            return min(end, start + travel)
+        return max(end, start - travel)
+    
+    @staticmethod
+    def _sweep_end_time(trajectory: Tuple[float, float, float, float]) -> float:
+        """Get the clock time at which a sweep timeline reaches its end."""
+        started, start, end, velocity = trajectory
+        if velocity <= 0:
+            return started
+        return started + abs(end - start) / velocity
+    
+    def angle_at(self, timestamp: float) -> float:
+        """
+        Get the servo angle at a clock time during a continuous sweep.
+        
+        The commanded angle is shifted by SERVO_TRACKING_LAG to account for
+        the horn trailing its PWM target.
+        
+        Args:
+            timestamp: clock.monotonic() value
+            
+        Returns:
+            Interpolated angle in degrees (the current angle if not sweeping)
+        """
+        trajectory = self._trajectory
+        if trajectory is None:
+            return self._current_angle
+        return self._trajectory_angle(timestamp - SERVO_TRACKING_LAG, trajectory)
+    
+    def stop_sweep(self) -> float:
+        """
+        Stop a continuous sweep and hold the servo where it is.
+        
+        Returns:
+            Angle the servo stopped at in degrees
+        """
+        if self._sweep_thread is not None:
+            self._sweep_stop.set()
+            self._sweep_thread.join()
+            self._sweep_thread = None
+        
+        trajectory = self._trajectory
+        if trajectory is not None:
+            self._current_angle = self._trajectory_angle(self.clock.monotonic(), trajectory)
+            self._set_angle(self._current_angle)
+            self._trajectory = None
+        return self._current_angle
+    
+    @property
+    def is_sweeping(self) -> bool:
+        """Check if a continuous sweep is still under way."""
+        trajectory = self._trajectory
+        if trajectory is None:
+            return False
+        return self.clock.monotonic() < self._sweep_end_time(trajectory) + SERVO_TRACKING_LAG
+    
     def get_angle(self) -> float:
         """
         Get current servo angle.
@@ -213,6 +333,9 @@ class ServoController:
         Returns:
             Current angle in degrees
         """
+        trajectory = self._trajectory
+        if trajectory is not None:
+            return self._trajectory_angle(self.clock.monotonic(), trajectory)
         return self._current_angle
     
     def detach(self):
@@ -230,6 +353,7 @@ class ServoController:
         """
         Close the servo and release resources.
         """
+        self.stop_sweep()
         if self._servo is not None:
             try:
                 self._servo.close()
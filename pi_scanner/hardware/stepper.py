@@ -4,8 +4,7 @@ Uses half-step sequence for smoother operation.
 """
 
 import logging
-import time
-from typing import List
+from typing import Callable, List, Optional
 
 try:
     import RPi.GPIO as GPIO
@@ -13,6 +12,7 @@ try:
 except ImportError:
     HAS_GPIO = False
 
+from .clock import Clock, SYSTEM_CLOCK
 from ..config import (
     STEPPER_PINS,
     STEPPER_STEPS_PER_REVOLUTION,
@@ -43,16 +43,19 @@ class StepperMotor:
     Uses half-step sequence for 4096 steps per revolution (360 degrees).
     """
     
-    def __init__(self, pins: dict = None, simulate: bool = False):
+    def __init__(self, pins: dict = None, simulate: bool = False,
+                 clock: Clock = SYSTEM_CLOCK):
         """
         Initialize the stepper motor controller.
         
         Args:
             pins: Dictionary with IN1, IN2, IN3, IN4 pin numbers (BCM)
             simulate: If True, run in simulation mode without real hardware
+            clock: Time source for step timing
         """
         self.pins = pins or STEPPER_PINS
         self.simulate = simulate
+        self.clock = clock
         self._pin_list: List[int] = [
             self.pins['IN1'],
             self.pins['IN2'],
@@ -98,6 +101,10 @@ class StepperMotor:
             logger.error(f"Failed to initialize stepper motor: {e}")
             return False
     
+    def _simulated_time_scale(self) -> float:
+        """Get the factor on simulated step times (faster in real-time simulation)."""
+        return 1.0 if self.clock.virtual else 0.1
+    
     def _set_step(self, step_index: int):
         """
         Set GPIO outputs for a specific step in the sequence.
@@ -112,23 +119,34 @@ class StepperMotor:
         for i, pin in enumerate(self._pin_list):
             GPIO.output(pin, GPIO.HIGH if sequence[i] else GPIO.LOW)
     
-    def _step_motor(self, steps: int, clockwise: bool = True):
+    def _step_motor(self, steps: int, clockwise: bool = True,
+                    cancel: Optional[Callable[[], bool]] = None) -> int:
         """
         Move stepper motor by specified number of steps.
         
         Args:
             steps: Number of steps to move
             clockwise: Direction of rotation
+            cancel: Checked before every step; the move ends early once it returns True
+            
+        Returns:
+            Number of steps taken
         """
         direction = 1 if clockwise else -1
+        delay = STEPPER_STEP_DELAY * (self._simulated_time_scale() if self.simulate else 1.0)
         
+        taken = 0
         for _ in range(abs(steps)):
+            if cancel is not None and cancel():
+                break
             self._current_step = (self._current_step + direction) % 8
             self._set_step(self._current_step)
-            time.sleep(STEPPER_STEP_DELAY)
+            self.clock.sleep(delay)
+            taken += 1
         
         # Turn off coils to save power and reduce heat
         self._release()
+        return taken
     
     def _release(self):
         """Turn off all coils to save power."""
@@ -138,13 +156,15 @@ class StepperMotor:
         for pin in self._pin_list:
             GPIO.output(pin, GPIO.LOW)
     
-    def move_degrees(self, degrees: float, clockwise: bool = True) -> float:
+    def move_degrees(self, degrees: float, clockwise: bool = True,
+                     cancel: Optional[Callable[[], bool]] = None) -> float:
         """
         Move stepper motor by specified degrees.
         
         Args:
             degrees: Degrees to rotate
             clockwise: Direction of rotation
+            cancel: Checked before every step; the move ends early once it returns True
             
         Returns:
             New absolute angle position
@@ -154,12 +174,10 @@ class StepperMotor:
             return self._current_angle
             
         steps = int(abs(degrees) * self._steps_per_degree)
-        
-        if self.simulate:
-            # Simulate movement delay
-            time.sleep(steps * STEPPER_STEP_DELAY * 0.1)
-        else:
-            self._step_motor(steps, clockwise)
+        taken = self._step_motor(steps, clockwise, cancel)
+        if taken < steps:
+            # Cancelled: track the angle actually reached
+            degrees = taken / self._steps_per_degree
         
         # Update angle tracking
         if clockwise:
@@ -172,12 +190,14 @@ class StepperMotor:
         
         return self._current_angle
     
-    def move_to_angle(self, target_angle: float) -> float:
+    def move_to_angle(self, target_angle: float,
+                      cancel: Optional[Callable[[], bool]] = None) -> float:
         """
         Move to an absolute angle position (0-360).
         
         Args:
             target_angle: Target angle in degrees (0-360)
+            cancel: Checked before every step; the move ends early once it returns True
             
         Returns:
             Actual angle position
@@ -200,7 +220,7 @@ class StepperMotor:
             clockwise = diff < 0
             degrees_to_move = 360 - abs(diff)
         
-        return self.move_degrees(degrees_to_move, clockwise)
+        return self.move_degrees(degrees_to_move, clockwise, cancel)
     
     def increment(self, degrees: float = STEPPER_DEGREES_PER_INCREMENT) -> float:
         """
@@ -223,6 +243,16 @@ class StepperMotor:
         self._current_angle = 0.0
         logger.info("Stepper position reset to 0 degrees")
     
+    def set_position(self, angle: float):
+        """
+        Set the angle tracking to a known position (does not physically move motor).
+        
+        Args:
+            angle: Angle the motor stands at in degrees
+        """
+        self._current_angle = angle % 360
+        logger.info(f"Stepper position set to {self._current_angle:.2f} degrees")
+    
     def get_angle(self) -> float:
         """
         Get current stepper angle.
@@ -0,0 +1,146 @@
+"""
+Several VL53L1X sensors on one I2C bus.
+
+Every VL53L1X powers up at the same default address, so sensors sharing a
+bus are held in reset through their XSHUT pins at boot, then released one
+at a time, each moved to its own address before the next comes up. The
+sensors are mounted on the servo arm at angular offsets from the main
+sensor (see TOFSensor.theta_offset and phi_offset).
+"""
+
+import logging
+from typing import List, Optional
+
+from .clock import Clock, SYSTEM_CLOCK
+from .tof_sensor import TOFSensor
+from ..config import I2C_BUS, TOF_I2C_ADDRESS, TOF_SENSORS
+
+logger = logging.getLogger(__name__)
+
+
+class TOFSensorArray:
+    """
+    The TOF sensors of the scanner head, the main sensor first.
+    
+    The main sensor's beam defines the scan's servo and stepper angles;
+    the others range alongside it and are brought up with it.
+    """
+    
+    def __init__(self, sensors: List[TOFSensor]):
+        """
+        Initialize the array.
+        
+        Args:
+            sensors: Sensors on the bus, the main one first
+        """
+        if not sensors:
+            raise ValueError("A sensor array needs at least one sensor")
+        self.sensors = list(sensors)
+    
+    @classmethod
+    def from_config(cls, simulate: bool = False, clock: Clock = SYSTEM_CLOCK,
+                    i2c_bus: int = I2C_BUS,
+                    config: Optional[List[dict]] = None) -> 'TOFSensorArray':
+        """
+        Create the sensors described in the configuration.
+        
+        Args:
+            simulate: If True, run in simulation mode without real hardware
+            clock: Time source of the sensors
+            i2c_bus: I2C bus the sensors share
+            config: Sensor descriptions (default: TOF_SENSORS)
+        
+        Returns:
+            The array
+        """
+        sensors = [
+            TOFSensor(
+                i2c_bus=i2c_bus,
+                simulate=simulate,
+                clock=clock,
+                address=entry.get('address', TOF_I2C_ADDRESS),
+                xshut_pin=entry.get('xshut_pin'),
+                gpio1_pin=entry.get('gpio1_pin'),
+                theta_offset=entry.get('theta_offset', 0.0),
+                phi_offset=entry.get('phi_offset', 0.0)
+            )
+            for entry in (config if config is not None else TOF_SENSORS)
+        ]
+        return cls(sensors or [TOFSensor(i2c_bus=i2c_bus, simulate=simulate, clock=clock)])
+    
+    @property
+    def main(self) -> TOFSensor:
+        """Get the main sensor."""
+        return self.sensors[0]
+    
+    @property
+    def extras(self) -> List[TOFSensor]:
+        """Get the sensors beside the main one."""
+        return self.sensors[1:]
+    
+    def __len__(self) -> int:
+        return len(self.sensors)
+    
+    def _check_wiring(self) -> bool:
+        """Check that every sensor can be given its own address."""
+        addresses = [sensor.address for sensor in self.sensors]
+        if len(set(addresses)) != len(addresses):
+            logger.error(f"TOF sensors share I2C addresses: {[hex(a) for a in addresses]}")
+            return False
+        for sensor in self.extras:
+            if sensor.xshut_pin is None:
+                logger.error(f"TOF sensor 0x{sensor.address:02x} needs an XSHUT pin")
+                return False
+        if self.main.xshut_pin is None and self.main.address == TOF_I2C_ADDRESS:
+            logger.error("Main TOF sensor without XSHUT needs an address of its own")
+            return False
+        return True
+    
+    def initialize(self) -> bool:
+        """
+        Bring the sensors up one at a time.
+        
+        An extra sensor that fails to come up is left out; the scan goes on
+        with the others.
+        
+        Returns:
+            True if at least the main sensor was initialized
+        """
+        if len(self.sensors) > 1 and not self.main.simulate:
+            if not self._check_wiring():
+                return False
+            for sensor in self.sensors:
+                sensor.hold_in_reset()
+        
+        if not self.main.initialize():
+            return False
+        
+        ready = [self.main]
+        for sensor in self.extras:
+            if sensor.initialize():
+                ready.append(sensor)
+            else:
+                # Back into reset so it cannot answer at the default address
+                sensor.hold_in_reset()
+                logger.error(f"TOF sensor 0x{sensor.address:02x} left out of the scan")
+        self.sensors = ready
+        
+        if len(ready) > 1:
+            logger.info(f"{len(ready)} TOF sensors ranging")
+        return True
+    
+    def close(self):
+        """Close every sensor."""
+        for sensor in self.sensors:
+            sensor.close()
+    
+    def to_dict(self) -> List[dict]:
+        """Convert to a list of sensor descriptions for JSON serialization."""
+        return [
+            {
+                'address': sensor.address,
+                'theta_offset': sensor.theta_offset,
+                'phi_offset': sensor.phi_offset
+            }
+            for sensor in self.sensors
+        ]
@@ -0,0 +1,127 @@
+"""
+Regions of interest (ROI) of the VL53L1X SPAD array.
+
+The sensor's 16x16 SPAD array sees a field of view of about 27 degrees.
+Ranging on a sub-array (at least 4x4 SPADs) narrows the beam to part of
+that field, steered off the optical axis by the ROI's distance from the
+array centre. Ranging a grid of ROIs in turn samples several directions
+without moving the mechanism.
+"""
+
+import math
+from dataclasses import dataclass
+from typing import List, Tuple
+
+from ..config import TOF_ROI_GRID, TOF_ROI_SIZE, TOF_ROI_SPACING, TOF_ROI_STEER
+
+# SPADs per side of the array
+SPAD_ARRAY_SIZE = 16
+
+# Smallest ROI the sensor ranges on (SPADs per side)
+ROI_MIN_SIZE = 4
+
+
+@dataclass(frozen=True)
+class SubField:
+    """An ROI of the SPAD array and the direction it steers the beam to."""
+    x: int          # Column of the ROI's first SPAD (0 = left)
+    y: int          # Row of the ROI's first SPAD (0 = bottom)
+    size: int       # Width and height in SPADs
+    along: float    # Beam offset along the servo's motion (degrees)
+    across: float   # Beam offset along the stepper's motion (degrees)
+    
+    @property
+    def corners(self) -> Tuple[int, int, int, int]:
+        """Get (top-left x, top-left y, bottom-right x, bottom-right y) as the driver takes them."""
+        return (self.x, self.y + self.size - 1, self.x + self.size - 1, self.y)
+    
+    def to_dict(self) -> dict:
+        """Convert to dictionary for JSON serialization."""
+        return {
+            'x': self.x,
+            'y': self.y,
+            'size': self.size,
+            'along': self.along,
+            'across': self.across
+        }
+
+
+# The whole array: the default, unsteered beam
+FULL_FIELD = SubField(0, 0, SPAD_ARRAY_SIZE, 0.0, 0.0)
+
+
+def sub_field_grid(grid: int = TOF_ROI_GRID, size: int = TOF_ROI_SIZE,
+                   spacing: int = TOF_ROI_SPACING,
+                   steer: Tuple[float, float] = TOF_ROI_STEER) -> List[SubField]:
+    """
+    Lay out a square grid of ROIs centred on the SPAD array.
+    
+    Args:
+        grid: ROIs per side of the grid
+        size: Width and height of each ROI in SPADs
+        spacing: SPADs between neighbouring ROI centres
+        steer: Beam steering per SPAD along the servo's and the stepper's
+               motion in degrees
+    
+    Returns:
+        The ROIs row by row
+    
+    Raises:
+        ValueError: If the grid does not fit the SPAD array
+    """
+    if not ROI_MIN_SIZE <= size <= SPAD_ARRAY_SIZE:
+        raise ValueError(f"ROI size must be {ROI_MIN_SIZE} to {SPAD_ARRAY_SIZE} SPADs")
+    if grid < 1 or (grid > 1 and spacing < 1):
+        raise ValueError("ROI grid needs at least one ROI and a positive spacing")
+    
+    first = (SPAD_ARRAY_SIZE - size - (grid - 1) * spacing) // 2
+    if first < 0:
+        raise ValueError(f"{grid}x{grid} ROIs of {size} SPADs, {spacing} apart, "
+                         f"do not fit the {SPAD_ARRAY_SIZE}x{SPAD_ARRAY_SIZE} SPAD array")
+    
+    fields = []
+    for row in range(grid):
+        for col in range(grid):
+            x = first + col * spacing
+            y = first + row * spacing
+            # Shift of the ROI centre from the array centre in SPADs
+            shift_x = x + size / 2 - SPAD_ARRAY_SIZE / 2
+            shift_y = y + size / 2 - SPAD_ARRAY_SIZE / 2
+            fields.append(SubField(x, y, size, shift_y * steer[0], shift_x * steer[1]))
+    return fields
+
+
+def steer_angles(theta: float, phi: float, along: float,
+                 across: float) -> Tuple[float, float]:
+    """
+    Get the servo and stepper angles that point the beam where a steered one points.
+    
+    The steered beam leaves the sensor at `along` degrees off the beam
+    towards increasing servo angle and `across` degrees towards increasing
+    stepper angle, as a pixel off the centre of a camera would.
+    
+    Args:
+        theta: Servo angle of the unsteered beam in degrees
+        phi: Stepper angle of the unsteered beam in degrees
+        along: Steering along the servo's motion in degrees
+        across: Steering along the stepper's motion in degrees
+    
+    Returns:
+        Tuple of (servo angle, stepper angle 0-360) in degrees
+    """
+    if along == 0.0 and across == 0.0:
+        return theta, phi
+    
+    t = math.radians(theta)
+    p = math.radians(phi)
+    sin_t, cos_t = math.sin(t), math.cos(t)
+    sin_p, cos_p = math.sin(p), math.cos(p)
+    a = math.tan(math.radians(along))
+    b = math.tan(math.radians(across))
+    
+    # Beam + a * (unit vector of increasing theta) + b * (of increasing phi)
+    x = sin_t * cos_p + a * cos_t * cos_p - b * sin_p
+    y = sin_t * sin_p + a * cos_t * sin_p + b * cos_p
+    z = cos_t - a * sin_t
+    return (math.degrees(math.atan2(math.hypot(x, y), z)),
+            math.degrees(math.atan2(y, x)) % 360)
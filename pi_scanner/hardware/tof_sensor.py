@@ -3,7 +3,8 @@ VL53L1X Time-of-Flight sensor interface for Raspberry Pi.
 """
 
 import logging
-from typing import Optional
+import math
+from typing import Callable, List, Optional, Tuple
 
 try:
     import vl53l1x
@@ -11,38 +12,115 @@ try:
 except ImportError:
     HAS_VL53L1X = False
 
+try:
+    import RPi.GPIO as GPIO
+    HAS_GPIO = True
+except ImportError:
+    HAS_GPIO = False
+
+try:
+    from smbus2 import SMBus, i2c_msg
+    HAS_SMBUS = True
+except ImportError:
+    HAS_SMBUS = False
+
+from .clock import Clock, SYSTEM_CLOCK
+from .tof_roi import SubField, FULL_FIELD
 from ..config import (
     I2C_BUS,
     TOF_I2C_ADDRESS,
     TOF_TIMING_BUDGET,
     TOF_MAX_RANGE,
-    TOF_MIN_RANGE
+    TOF_MIN_RANGE,
+    TOF_INTER_MEASUREMENT,
+    TOF_INTERRUPT_ACTIVE_HIGH
 )
 
 logger = logging.getLogger(__name__)
 
+# Status of a ranging, as passed to raw reading callbacks
+RANGE_STATUS_VALID = 0
+RANGE_STATUS_OUT_OF_RANGE = 1  # Outside TOF_MIN_RANGE..TOF_MAX_RANGE
+RANGE_STATUS_FAILED = 2        # No result (read error, no target)
+
+# Time the sensor takes to boot once XSHUT is released (seconds)
+TOF_BOOT_TIME = 0.002
+
+# Result block read in one transfer on data ready: RESULT__RANGE_STATUS
+# (0x0089) onwards, 17 bytes, the range in mm at bytes 13-14
+RESULT_REGISTER = 0x0089
+RESULT_LENGTH = 17
+INTERRUPT_CLEAR_REGISTER = 0x0086
+
+# Range status codes of the result block that mean a valid range
+RESULT_STATUS_VALID = (9,)
+
+# Longest wait for a data-ready edge, in measurement periods
+INTERRUPT_TIMEOUT_PERIODS = 3
+
 
 class TOFSensor:
     """
     Interface for the VL53L1X Time-of-Flight distance sensor.
     
     Provides distance measurements in millimeters using I2C communication.
+    With GPIO1 wired, a reading waits for the sensor's data-ready interrupt
+    and fetches the result in one burst read instead of polling.
     """
     
-    def __init__(self, i2c_bus: int = I2C_BUS, simulate: bool = False):
+    def __init__(self, i2c_bus: int = I2C_BUS, simulate: bool = False,
+                 clock: Clock = SYSTEM_CLOCK, address: int = TOF_I2C_ADDRESS,
+                 xshut_pin: Optional[int] = None, theta_offset: float = 0.0,
+                 phi_offset: float = 0.0, gpio1_pin: Optional[int] = None):
         """
         Initialize the TOF sensor.
         
         Args:
             i2c_bus: I2C bus number (default: 1 for /dev/i2c-1)
             simulate: If True, run in simulation mode without real hardware
+            clock: Time source for timestamps and simulated ranging
+            address: I2C address to move the sensor to at initialization
+            xshut_pin: GPIO pin (BCM) wired to XSHUT, or None if tied high
+            theta_offset: Beam direction off the servo angle in degrees
+            phi_offset: Beam direction off the stepper angle in degrees
+            gpio1_pin: GPIO pin (BCM) wired to the data-ready output GPIO1,
+                       or None to poll for results
         """
         self.i2c_bus = i2c_bus
         self.simulate = simulate
+        self.clock = clock
+        self.address = address
+        self.xshut_pin = xshut_pin
+        self.theta_offset = theta_offset
+        self.phi_offset = phi_offset
+        self.gpio1_pin = gpio1_pin
+        self._sub_field = FULL_FIELD
         self._sensor = None
         self._initialized = False
         self._simulation_distance = 500  # Default simulation distance
+        # Simulated scene and the beam (origin, direction) at a clock time
+        self._scene = None
+        self._beam: Optional[Callable[[float], Tuple]] = None
+        
+        # Called with (raw distance, status, latch time) for every ranging
+        self._raw_callbacks: List[Callable[[int, int, float], None]] = []
+        
+        # Integration time per reading and running estimate of the time
+        # between back-to-back readings in continuous ranging (seconds)
+        self._integration_time = TOF_TIMING_BUDGET / 1e6
+        self._measurement_gap = 0.0
+        self._measurement_period = self._integration_time + self._ranging_gap
+        self._last_ready: Optional[float] = None
         
+        # Data-ready interrupt: set on each GPIO1 edge, with its clock time
+        self._bus = None
+        self._data_ready = clock.event()
+        self._ready_at: Optional[float] = None
+        # Clock time the result just read was latched, if known exactly,
+        # and the latch time of the last reading
+        self._result_at: Optional[float] = None
+        self._latch_time: Optional[float] = None
+    
     def initialize(self) -> bool:
         """
         Initialize and configure the TOF sensor.
@@ -60,14 +138,18 @@ class TOFSensor:
             return False
             
         try:
-            self._sensor = vl53l1x.VL53L1X(i2c_bus=self.i2c_bus, i2c_address=TOF_I2C_ADDRESS)
-            self._sensor.open()
-            
-            # Configure timing budget for accuracy vs speed tradeoff
-            # 1 = Short range (fast), 2 = Medium, 3 = Long range (slow but accurate)
-            self._sensor.start_ranging(2)  # Medium range mode
+            if self.xshut_pin is not None:
+                # Out of reset at the default address
+                self._set_xshut(True)
+                self.clock.sleep(TOF_BOOT_TIME)
+            self._open()
+            if self.gpio1_pin is not None:
+                self._enable_interrupt()
+            self._start_ranging()
             
-            logger.info(f"VL53L1X TOF sensor initialized on I2C bus {self.i2c_bus}")
+            logger.info(f"VL53L1X TOF sensor initialized on I2C bus {self.i2c_bus} "
+                        f"at address 0x{self.address:02x}"
+                        + (f", data ready on GPIO {self.gpio1_pin}" if self._bus is not None else ""))
             self._initialized = True
             return True
             
@@ -75,6 +157,169 @@ class TOFSensor:
             logger.error(f"Failed to initialize TOF sensor: {e}")
             return False
     
+    def _open(self):
+        """Open the sensor at the default address and move it to its own."""
+        try:
+            self._sensor = vl53l1x.VL53L1X(i2c_bus=self.i2c_bus, i2c_address=TOF_I2C_ADDRESS)
+            self._sensor.open()
+        except Exception:
+            if self.address == TOF_I2C_ADDRESS or self.xshut_pin is not None:
+                raise
+            # Without XSHUT the sensor keeps its address until power is cut
+            self._sensor = vl53l1x.VL53L1X(i2c_bus=self.i2c_bus, i2c_address=self.address)
+            self._sensor.open()
+            return
+        if self.address != TOF_I2C_ADDRESS:
+            self._sensor.change_address(self.address)
+    
+    def _enable_interrupt(self):
+        """Read results on GPIO1 data-ready edges instead of polling."""
+        if not HAS_GPIO or not HAS_SMBUS:
+            logger.warning("Data-ready interrupt needs RPi.GPIO and smbus2; polling the TOF sensor")
+            return
+        GPIO.setmode(GPIO.BCM)
+        GPIO.setwarnings(False)
+        GPIO.setup(self.gpio1_pin, GPIO.IN, pull_up_down=GPIO.PUD_UP)
+        GPIO.add_event_detect(self.gpio1_pin,
+                              GPIO.RISING if TOF_INTERRUPT_ACTIVE_HIGH else GPIO.FALLING,
+                              callback=self._on_data_ready)
+        self._bus = SMBus(self.i2c_bus)
+    
+    def _on_data_ready(self, channel: int):
+        """GPIO1 edge: a result was latched (GPIO callback thread)."""
+        self._ready_at = self.clock.monotonic()
+        self._data_ready.set()
+    
+    def _set_xshut(self, released: bool):
+        """Drive the XSHUT pin: low holds the sensor in reset."""
+        GPIO.setmode(GPIO.BCM)
+        GPIO.setwarnings(False)
+        GPIO.setup(self.xshut_pin, GPIO.OUT)
+        GPIO.output(self.xshut_pin, GPIO.HIGH if released else GPIO.LOW)
+    
+    def hold_in_reset(self) -> bool:
+        """
+        Hold the sensor in reset through XSHUT until initialize().
+        
+        Returns:
+            True if the sensor is in reset, False if XSHUT is not wired
+            (or in simulation mode)
+        """
+        if self.simulate or self.xshut_pin is None:
+            return False
+        if not HAS_GPIO:
+            logger.error("RPi.GPIO library not installed. Install with: pip install RPi.GPIO")
+            return False
+        self._set_xshut(False)
+        return True
+    
+    def _start_ranging(self):
+        """Apply the timing configuration and start continuous ranging."""
+        # The sensor must rest at least 4 ms between rangings
+        period_ms = max(math.ceil(TOF_TIMING_BUDGET / 1000) + 4,
+                        TOF_INTER_MEASUREMENT or 0,
+                        math.ceil((self._integration_time + self._measurement_gap) * 1000))
+        self._sensor.set_timing(TOF_TIMING_BUDGET, period_ms)
+        self._data_ready.clear()
+        
+        # Configure timing budget for accuracy vs speed tradeoff
+        # 1 = Short range (fast), 2 = Medium, 3 = Long range (slow but accurate)
+        self._sensor.start_ranging(2)  # Medium range mode
+    
+    def set_measurement_gap(self, gap: float) -> bool:
+        """
+        Set the idle time between back-to-back rangings.
+        
+        A gap lets a mechanism move between readings without smearing an
+        integration; with no gap the sensor ranges as fast as its timing
+        budget allows.
+        
+        Args:
+            gap: Idle time after each ranging in seconds
+            
+        Returns:
+            True if the timing was applied
+        """
+        gap = max(0.0, gap)
+        if gap == self._measurement_gap:
+            return True
+        self._measurement_gap = gap
+        self._measurement_period = self._integration_time + self._ranging_gap
+        
+        if self._sensor is None:
+            return True
+        try:
+            self._sensor.stop_ranging()
+            self._start_ranging()
+            return True
+        except Exception as e:
+            logger.error(f"Failed to set TOF ranging gap: {e}")
+            return False
+    
+    def restart_ranging(self):
+        """
+        Restart continuous ranging now.
+        
+        The next result latches one measurement period from now, which
+        sets the phase of this sensor's rangings against other sensors.
+        """
+        self._last_ready = None
+        if self._sensor is None:
+            return
+        try:
+            self._sensor.stop_ranging()
+            self._start_ranging()
+        except Exception as e:
+            logger.error(f"Failed to restart TOF ranging: {e}")
+    
+    def set_sub_field(self, field: SubField) -> bool:
+        """
+        Range on a region of interest of the SPAD array.
+        
+        Ranging restarts, so the next result comes from the new ROI.
+        
+        Args:
+            field: ROI to range on (FULL_FIELD for the whole array)
+            
+        Returns:
+            True if the ROI was applied
+        """
+        if field == self._sub_field:
+            return True
+        self._sub_field = field
+        self._last_ready = None
+        if self._sensor is None:
+            return True
+        try:
+            self._sensor.stop_ranging()
+            self._sensor.set_user_roi(vl53l1x.VL53L1xUserRoi(*field.corners))
+            self._start_ranging()
+            return True
+        except Exception as e:
+            logger.error(f"Failed to set TOF region of interest: {e}")
+            return False
+    
+    @property
+    def sub_field(self) -> SubField:
+        """Get the region of interest the sensor ranges on."""
+        return self._sub_field
+    
+    @property
+    def _ranging_gap(self) -> float:
+        """Get the idle time between rangings: the measurement gap, or longer for TOF_INTER_MEASUREMENT."""
+        return max(self._measurement_gap,
+                   (TOF_INTER_MEASUREMENT or 0) / 1000 - self._integration_time)
+    
+    def on_raw_reading(self, callback: Callable[[int, int, float], None]):
+        """
+        Register a callback for every ranging, valid or not.
+        
+        Called from the reading thread with the raw distance in mm (0 if
+        there was none), the RANGE_STATUS_* code and the clock time the
+        result was latched.
+        """
+        self._raw_callbacks.append(callback)
+    
     def read_distance(self) -> Optional[int]:
         """
         Read current distance from the sensor.
@@ -85,31 +330,168 @@ class TOFSensor:
         if not self._initialized:
             logger.warning("TOF sensor not initialized")
             return None
-            
+        
+        self._result_at = None
+        distance, status = self._range()
+        latched = self._result_at if self._result_at is not None else self.clock.monotonic()
+        self._latch_time = latched
+        if self._raw_callbacks:
+            for callback in self._raw_callbacks:
+                try:
+                    callback(distance, status, latched)
+                except Exception as e:
+                    logger.error(f"Error in raw reading callback: {e}")
+        
+        return distance if status == RANGE_STATUS_VALID else None
+    
+    def _range(self) -> Tuple[int, int]:
+        """
+        Take one ranging.
+        
+        Returns:
+            Tuple of (raw distance in mm or 0, RANGE_STATUS_* code)
+        """
         if self.simulate:
-            return self._get_simulation_distance()
+            # A ranging takes one integration; sample the scene half way
+            start = self.clock.monotonic()
+            self.clock.sleep(self._integration_time)
+            distance = self._get_simulation_distance(start + self._integration_time / 2)
+            if distance is None:
+                return 0, RANGE_STATUS_FAILED
+            return distance, RANGE_STATUS_VALID
             
+        if self._bus is not None:
+            return self._read_result()
+        
         try:
             distance = self._sensor.get_distance()
-            
-            # Validate reading
-            if distance < TOF_MIN_RANGE or distance > TOF_MAX_RANGE:
-                logger.debug(f"TOF reading out of range: {distance}mm")
-                return None
-                
-            return distance
-            
         except Exception as e:
             logger.error(f"Failed to read TOF sensor: {e}")
-            return None
+            return 0, RANGE_STATUS_FAILED
+        return self._validate(distance)
     
-    def _get_simulation_distance(self) -> int:
+    def _read_result(self) -> Tuple[int, int]:
+        """
+        Wait for the data-ready edge, then read the result in one transfer.
+        
+        The interrupt is cleared whatever happens, so that a lost edge or a
+        failed transfer cannot leave GPIO1 asserted with no further edges.
+        
+        Returns:
+            Tuple of (raw distance in mm or 0, RANGE_STATUS_* code)
+        """
+        if not self._data_ready.is_set() and self._interrupt_asserted():
+            # Latched before the edge was caught; its exact time is lost
+            self._ready_at = self.clock.monotonic()
+            self._data_ready.set()
+        
+        block = None
+        if self._data_ready.wait(INTERRUPT_TIMEOUT_PERIODS * self._measurement_period):
+            self._data_ready.clear()
+            self._result_at = self._ready_at
+            try:
+                select = i2c_msg.write(self.address, [RESULT_REGISTER >> 8, RESULT_REGISTER & 0xFF])
+                result = i2c_msg.read(self.address, RESULT_LENGTH)
+                self._bus.i2c_rdwr(select, result)
+                block = list(result)
+            except OSError as e:
+                logger.error(f"Failed to read TOF result: {e}")
+        else:
+            logger.warning("No TOF data-ready interrupt within timeout")
+        
+        # Release GPIO1 for the next result
+        self._clear_interrupt()
+        if block is None:
+            # Any edge seen meanwhile belongs to the result just dropped
+            self._data_ready.clear()
+            return 0, RANGE_STATUS_FAILED
+        
+        distance = (block[13] << 8) | block[14]
+        if block[0] & 0x1F not in RESULT_STATUS_VALID:
+            return distance, RANGE_STATUS_FAILED
+        return self._validate(distance)
+    
+    def _interrupt_asserted(self) -> bool:
+        """Check if GPIO1 signals a result waiting to be read."""
+        return GPIO.input(self.gpio1_pin) == (GPIO.HIGH if TOF_INTERRUPT_ACTIVE_HIGH else GPIO.LOW)
+    
+    def _clear_interrupt(self) -> bool:
+        """
+        Clear the data-ready interrupt, releasing GPIO1.
+        
+        Returns:
+            True if the interrupt was cleared
+        """
+        try:
+            self._bus.i2c_rdwr(i2c_msg.write(
+                self.address, [INTERRUPT_CLEAR_REGISTER >> 8, INTERRUPT_CLEAR_REGISTER & 0xFF, 0x01]))
+            return True
+        except OSError as e:
+            logger.error(f"Failed to clear TOF interrupt: {e}")
+            return False
+    
+    def _validate(self, distance: int) -> Tuple[int, int]:
+        """Check a ranged distance against TOF_MIN_RANGE..TOF_MAX_RANGE."""
+        if distance < TOF_MIN_RANGE or distance > TOF_MAX_RANGE:
+            logger.debug(f"TOF reading out of range: {distance}mm")
+            return distance, RANGE_STATUS_OUT_OF_RANGE
+        
+        return distance, RANGE_STATUS_VALID
+    
+    def read_distance_timed(self) -> Tuple[Optional[int], float]:
+        """
+        Read the next continuous-ranging result with its timestamp.
+        
+        The sensor ranges back to back, so a result becomes available one
+        measurement period after the previous one; the reading describes the
+        middle of its integration window, half a timing budget before it was
+        latched (on the data-ready edge if GPIO1 is wired, else on return).
+        
+        Returns:
+            Tuple of (distance in mm or None, clock time at mid-integration)
+        """
+        if self.simulate and self._initialized:
+            # Pace simulated readings like the real sensor
+            self.clock.sleep(self._ranging_gap)
+        distance = self.read_distance()
+        ready = self._latch_time
+        
+        # Track the ranging rate from back-to-back reads (skip pauses)
+        if self._last_ready is not None:
+            interval = ready - self._last_ready
+            if interval < 10 * self._integration_time:
+                self._measurement_period += 0.2 * (interval - self._measurement_period)
+        self._last_ready = ready
+        
+        return distance, ready - self._integration_time / 2
+    
+    @property
+    def integration_time(self) -> float:
+        """Get the integration time of one reading in seconds."""
+        return self._integration_time
+    
+    @property
+    def measurement_period(self) -> float:
+        """Get the estimated time between continuous readings in seconds."""
+        return self._measurement_period
+    
+    def _get_simulation_distance(self, timestamp: Optional[float] = None) -> Optional[int]:
         """
         Generate simulated distance reading for testing.
         
+        Args:
+            timestamp: Clock time the reading describes (for a scene)
+        
         Returns:
-            Simulated distance in millimeters
+            Simulated distance in millimeters, or None if the reading failed
         """
+        if self._scene is not None and self._beam is not None:
+            if timestamp is None:
+                timestamp = self.clock.monotonic()
+            origin, direction = self._beam(timestamp)
+            reading = float(self._scene.measure(origin, direction))
+            return None if math.isnan(reading) else int(round(reading))
+        
         import random
         # Add some noise to simulation
         noise = random.randint(-20, 20)
@@ -124,6 +506,18 @@ class TOFSensor:
         """
         self._simulation_distance = distance
     
+    def set_simulation_scene(self, scene, beam: Callable[[float], Tuple]):
+        """
+        Measure a simulated scene instead of a fixed distance.
+        
+        Args:
+            scene: simulation.Scene to range against
+            beam: Function from a clock time to the beam's (origin,
+                  direction) in the scanner frame at that time
+        """
+        self._scene = scene
+        self._beam = beam
+    
     def close(self):
         """
         Close the sensor and release resources.
@@ -135,6 +529,10 @@ class TOFSensor:
                 logger.info("TOF sensor closed")
             except Exception as e:
                 logger.error(f"Error closing TOF sensor: {e}")
+        if self._bus is not None:
+            GPIO.remove_event_detect(self.gpio1_pin)
+            self._bus.close()
+            self._bus = None
         self._initialized = False
     
     @property
@@ -17,6 +17,21 @@ Options:
     --host HOST     Web server host (default: 0.0.0.0)
     --port PORT     Web server port (default: 5000)
     --debug         Enable debug mode
+    --spill         Keep all points in memory-mapped files (no size limit)
+    --continuous    Sweep the servo continuously instead of stop-settle-read
+    --pipelined     Overlap servo settling with sensor integration in stepped sweeps
+    --sub-fields    Range a grid of SPAD regions of interest at every pose
+    --pattern NAME  Scan order: raster, serpentine, spiral or progressive
+                    (default: raster)
+    --virtual-time  With --simulate or --replay, run scans on a virtual clock
+                    (faster than real time, same simulated timing)
+    --record        Journal the raw acquisition events of every scan
+    --journal       Journal every scan so one cut short by a crash or power
+                    loss can be resumed
+    --replay FILE   Play a recorded acquisition session back instead of
+                    using the hardware
+    --benchmark     With --replay, run the recorded scan without the web
+                    server and print its throughput
 """
 
 import argparse
@@ -24,13 +39,19 @@ import logging
 import signal
 import sys
 import os
+import time
 
 # Add parent directory to path for imports
 sys.path.insert(0, os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
 
-from pi_scanner.scanner.coordinator import ScanCoordinator
+from pi_scanner.hardware import VirtualClock, SYSTEM_CLOCK, AcquisitionLog
+from pi_scanner.scanner.coordinator import ScanCoordinator, ScanState
+from pi_scanner.scanner.scan_plan import ScanPlan, SCAN_ORDERS
 from pi_scanner.web.server import create_app, run_server
-from pi_scanner.config import WEB_HOST, WEB_PORT, WEB_DEBUG
+from pi_scanner.config import (
+    WEB_HOST, WEB_PORT, WEB_DEBUG, POINT_CLOUD_SPILL, SCAN_CONTINUOUS, SCAN_PIPELINED, SCAN_PATTERN,
+    ACQUISITION_RECORD, TOF_ROI_SCAN, SCAN_JOURNAL
+)
 
 # Configure logging
 logging.basicConfig(
@@ -62,6 +83,19 @@ Examples:
 
     # Run with debug logging
     python -m pi_scanner.main --debug
+
+    # Keep very large scans on disk instead of dropping old points
+    python -m pi_scanner.main --spill
+
+    # Faster scans with continuous servo motion
+    python -m pi_scanner.main --continuous
+
+    # Simulated scans as fast as the CPU allows
+    python -m pi_scanner.main --simulate --virtual-time
+    
+    # Record scans on site, then benchmark one on a dev box
+    python -m pi_scanner.main --record
+    python -m pi_scanner.main --replay scans/acquisition_20250101_120000.acq --benchmark --virtual-time
         """
     )
     
@@ -91,6 +125,76 @@ Examples:
         help='Enable debug mode with verbose logging'
     )
     
+    parser.add_argument(
+        '--spill',
+        action='store_true',
+        default=POINT_CLOUD_SPILL,
+        help='Keep all points in memory-mapped files under the export directory'
+    )
+    
+    parser.add_argument(
+        '--continuous',
+        action='store_true',
+        default=SCAN_CONTINUOUS,
+        help='Sweep the servo at constant velocity while ranging back to back'
+    )
+    
+    parser.add_argument(
+        '--pipelined',
+        action='store_true',
+        default=SCAN_PIPELINED,
+        help='In stepped sweeps, command the next angle just before each reading latches '
+             'so the servo settles between rangings'
+    )
+    
+    parser.add_argument(
+        '--sub-fields',
+        action='store_true',
+        default=TOF_ROI_SCAN,
+        help='Range a grid of SPAD regions of interest at every pose, steering the beam '
+             'to several directions per mechanical move'
+    )
+    
+    parser.add_argument(
+        '--pattern',
+        choices=SCAN_ORDERS,
+        default=SCAN_PATTERN,
+        help=f'Scan order (default: {SCAN_PATTERN})'
+    )
+    
+    parser.add_argument(
+        '--virtual-time',
+        action='store_true',
+        help='With --simulate or --replay, run on a virtual clock instead of waiting in real time'
+    )
+    
+    parser.add_argument(
+        '--record',
+        action='store_true',
+        default=ACQUISITION_RECORD,
+        help='Journal the raw acquisition events of every scan under the export directory'
+    )
+    
+    parser.add_argument(
+        '--journal',
+        action='store_true',
+        default=SCAN_JOURNAL,
+        help='Journal every scan under the export directory so an interrupted one can be resumed'
+    )
+    
+    parser.add_argument(
+        '--replay',
+        type=str,
+        metavar='FILE',
+        help='Play a recorded acquisition session back instead of using the hardware'
+    )
+    
+    parser.add_argument(
+        '--benchmark',
+        action='store_true',
+        help='With --replay, run the recorded scan headless and print its throughput'
+    )
+    
     return parser.parse_args()
 
 
@@ -105,6 +209,52 @@ def setup_signal_handlers(scanner: ScanCoordinator):
     signal.signal(signal.SIGTERM, signal_handler)
 
 
+def run_benchmark(scanner: ScanCoordinator) -> int:
+    """
+    Run the replayed scan without the web server and print its throughput.
+    
+    Args:
+        scanner: Initialized coordinator replaying a recording
+    
+    Returns:
+        Exit code
+    """
+    finished = []
+    scanner.on_state_change(
+        lambda state: finished.append(state) if state in (ScanState.IDLE, ScanState.ERROR) else None)
+    
+    started = time.perf_counter()
+    if not scanner.start_scan():
+        logger.error("Failed to start the replayed scan")
+        return 1
+    while not finished:
+        time.sleep(0.05)
+    elapsed = time.perf_counter() - started
+    if finished[0] == ScanState.ERROR:
+        logger.error("Replayed scan failed")
+        return 1
+    
+    replay = scanner.get_replay()
+    timeline = scanner.get_timeline()
+    points = scanner.point_cloud.get_point_count()
+    print("\n" + "=" * 60)
+    print("Replay benchmark")
+    print("=" * 60)
+    print(f"Rangings replayed:  {replay['replayed']} of {replay['recorded']} "
+          f"({replay['diverged']} off the recorded position)")
+    print(f"Points:             {points}")
+    print(f"Wall time:          {elapsed:.2f}s ({replay['replayed'] / max(elapsed, 1e-9):.0f} rangings/s)")
+    print(f"Scan time:          {timeline['span_s']:.2f}s")
+    print(f"Sensor utilization: {timeline['sensor_utilization']:.1%}")
+    for name, stage in sorted(timeline['stages'].items()):
+        print(f"  {name:<12} {stage['count']:>7}  mean {stage['mean_ms']:7.2f}ms  "
+              f"max {stage['max_ms']:7.2f}ms  {stage['share']:6.1%}")
+    for name, count in sorted(timeline['counters'].items()):
+        print(f"  {name:<12} {count:>7}")
+    print("=" * 60 + "\n")
+    return 0
+
+
 def print_banner():
     """Print application banner."""
     banner = """
@@ -133,7 +283,7 @@ def main():
     print_banner()
     
     # Log startup info
-    mode = "SIMULATION" if args.simulate else "HARDWARE"
+    mode = "REPLAY" if args.replay else "SIMULATION" if args.simulate else "HARDWARE"
     logger.info(f"Starting 3D Spatial Eye in {mode} mode")
     logger.info(f"Web interface will be available at http://{args.host}:{args.port}")
     
@@ -142,7 +292,29 @@ def main():
         logger.info("Simulated distance readings will be generated")
     
     # Create scanner
-    scanner = ScanCoordinator(simulate=args.simulate)
+    if args.virtual_time and not (args.simulate or args.replay):
+        logger.error("--virtual-time requires --simulate or --replay")
+        return 1
+    if args.benchmark and not args.replay:
+        logger.error("--benchmark requires --replay")
+        return 1
+    replay = None
+    if args.replay:
+        try:
+            replay = AcquisitionLog.load(args.replay)
+        except (OSError, ValueError) as e:
+            logger.error(f"Failed to load recording: {e}")
+            return 1
+    clock = VirtualClock() if args.virtual_time else SYSTEM_CLOCK
+    scanner = ScanCoordinator(simulate=args.simulate, spill=args.spill, clock=clock, replay=replay,
+                              journal=args.journal)
+    scanner.record_acquisition = args.record
+    if replay is None:
+        # A replay scans with the recorded settings
+        scanner.continuous_sweep = args.continuous
+        scanner.pipelined = args.pipelined
+        scanner.sub_field_scan = args.sub_fields
+        scanner.plan = ScanPlan(order=args.pattern)
     
     # Set up signal handlers
     setup_signal_handlers(scanner)
@@ -158,6 +330,9 @@ def main():
         
         logger.info("Hardware initialized successfully")
         
+        if args.benchmark:
+            return run_benchmark(scanner)
+        
         # Create web application
         logger.info("Creating web application...")
         app, socketio = create_app(scanner)
@@ -3,6 +3,7 @@ Scanner modules for coordinating scans and managing point cloud data.
 """
 
 from .point_cloud import PointCloud
+from .range_image import RangeImage
 from .coordinator import ScanCoordinator
 
-__all__ = ['PointCloud', 'ScanCoordinator']
+__all__ = ['PointCloud', 'RangeImage', 'ScanCoordinator']
@@ -0,0 +1,349 @@
+"""
+Pipelined TOF acquisition with a per-stage timeline.
+
+The sensor ranges back to back on its own. A reader thread collects each
+result as soon as it is latched and hands it to data-ready callbacks, so
+the scan thread never blocks for a whole ranging: it commands the servo
+while the current integration finishes and only waits for results.
+
+Every stage (sensor integration, servo settling, the scan thread waiting
+for data or sleeping, result processing) is recorded in an
+AcquisitionTimeline to show where the scan time goes.
+"""
+
+import logging
+import threading
+from collections import deque
+from dataclasses import dataclass
+from typing import Callable, Dict, List, Optional
+
+from ..hardware import TOFSensor
+
+logger = logging.getLogger(__name__)
+
+# Stage intervals kept for plotting the latest part of the timeline
+TIMELINE_HISTORY = 2000
+
+# Mechanism moves kept to check readings against
+MOTION_HISTORY = 64
+
+
+@dataclass
+class TOFReading:
+    """One latched sensor result and the window it integrated over."""
+    distance: Optional[int]
+    integration_start: float  # Clock time
+    integration_end: float    # Clock time when the result was latched
+    
+    @property
+    def mid(self) -> float:
+        """Get the clock time at mid-integration."""
+        return (self.integration_start + self.integration_end) / 2
+
+
+class AcquisitionTimeline:
+    """
+    Per-stage timing of a scan.
+    
+    Stages are intervals of clock time keyed by name:
+    - integration: sensor integrating one reading
+    - settle: servo moving to and settling at a commanded angle
+    - sensor_wait: scan thread blocked waiting for a reading
+    - latch_wait: scan thread timing the next servo command to a latch
+    - settle_wait: scan thread sleeping while the servo settles
+    - processing: scan thread handling a reading
+    
+    Totals cover the whole scan; the latest intervals are kept for plotting.
+    Counters track readings that were dropped (e.g. 'discarded', 'missed').
+    """
+    
+    def __init__(self, history: int = TIMELINE_HISTORY):
+        """
+        Initialize an empty timeline.
+        
+        Args:
+            history: Number of latest intervals to keep
+        """
+        self._lock = threading.Lock()
+        self._history = history
+        self.clear()
+    
+    def clear(self):
+        """Forget all recorded stages."""
+        with self._lock:
+            self._totals: Dict[str, List[float]] = {}  # name -> [count, total, max]
+            self._counters: Dict[str, int] = {}
+            self._recent = deque(maxlen=self._history)
+            self._first: Optional[float] = None
+            self._last: Optional[float] = None
+    
+    def record(self, stage: str, start: float, end: float):
+        """
+        Record one interval of a stage.
+        
+        Args:
+            stage: Stage name
+            start: Clock time at the start of the interval
+            end: Clock time at the end of the interval
+        """
+        duration = max(0.0, end - start)
+        with self._lock:
+            totals = self._totals.setdefault(stage, [0, 0.0, 0.0])
+            totals[0] += 1
+            totals[1] += duration
+            totals[2] = max(totals[2], duration)
+            self._recent.append((stage, start, end))
+            self._first = start if self._first is None else min(self._first, start)
+            self._last = end if self._last is None else max(self._last, end)
+    
+    def count(self, name: str):
+        """Increment a counter (e.g. readings discarded)."""
+        with self._lock:
+            self._counters[name] = self._counters.get(name, 0) + 1
+    
+    def to_dict(self, recent: bool = False) -> dict:
+        """
+        Convert to dictionary for JSON serialization.
+        
+        Args:
+            recent: If True, include the latest intervals as
+                    [stage, start, end] in seconds from the start of the scan
+        
+        Returns:
+            Dictionary with the wall time span, per-stage totals and the
+            share of the span each stage took, and the counters
+        """
+        with self._lock:
+            span = (self._last - self._first) if self._first is not None else 0.0
+            stages = {
+                name: {
+                    'count': int(count),
+                    'total_s': total,
+                    'mean_ms': total / count * 1000 if count else 0.0,
+                    'max_ms': longest * 1000,
+                    'share': total / span if span > 0 else 0.0
+                }
+                for name, (count, total, longest) in self._totals.items()
+            }
+            result = {
+                'span_s': span,
+                'stages': stages,
+                'counters': dict(self._counters),
+                # Fraction of the scan the sensor spent integrating
+                'sensor_utilization': stages['integration']['share'] if 'integration' in stages else 0.0
+            }
+            if recent:
+                origin = self._first or 0.0
+                result['recent'] = [[stage, start - origin, end - origin]
+                                    for stage, start, end in self._recent]
+        return result
+
+
+class MotionLog:
+    """
+    Recent servo and stepper moves, to pose readings taken in other threads.
+    
+    The scan thread logs every move before commanding it, from the time
+    the mechanism starts moving until it has settled, with the servo's
+    target. A reading saw a still beam if no move overlapped its
+    integration; its servo angle is then the target of the last move
+    before it. During a continuous sweep the servo follows its trajectory
+    and servo_angle() returns None.
+    """
+    
+    def __init__(self, history: int = MOTION_HISTORY):
+        """
+        Initialize an empty log.
+        
+        Args:
+            history: Number of latest moves to keep
+        """
+        self._lock = threading.Lock()
+        self._moves = deque(maxlen=history)    # (start, settled)
+        self._targets = deque(maxlen=history)  # (start, servo angle or None)
+        self._moving_since: Optional[float] = None
+    
+    def add(self, start: float, settled: float, servo_angle: Optional[float] = None):
+        """
+        Log a move of known duration.
+        
+        Args:
+            start: Clock time the mechanism starts moving
+            settled: Clock time it is at rest again
+            servo_angle: Servo target of the move (None for a stepper move)
+        """
+        with self._lock:
+            self._moves.append((start, max(start, settled)))
+            if servo_angle is not None:
+                self._targets.append((start, servo_angle))
+    
+    def sweep(self, start: float):
+        """Log the start of a continuous servo sweep."""
+        with self._lock:
+            self._targets.append((start, None))
+    
+    def begin(self, start: float):
+        """Log the start of a move that lasts until end()."""
+        with self._lock:
+            self._moving_since = start
+    
+    def end(self, settled: float):
+        """Log the end of the move started with begin()."""
+        with self._lock:
+            if self._moving_since is not None:
+                self._moves.append((self._moving_since, settled))
+                self._moving_since = None
+    
+    def still(self, start: float, end: float) -> bool:
+        """
+        Check that nothing moved in an interval.
+        
+        Args:
+            start: Clock time at the start of the interval
+            end: Clock time at the end of the interval
+        
+        Returns:
+            True if no logged move overlaps the interval
+        """
+        with self._lock:
+            if self._moving_since is not None and self._moving_since <= end:
+                return False
+            return not any(moved <= end and settled >= start
+                           for moved, settled in self._moves)
+    
+    def servo_angle(self, timestamp: float) -> Optional[float]:
+        """
+        Get the servo target in force at a clock time.
+        
+        Returns:
+            Target angle in degrees, or None during a sweep or before the
+            first logged servo move
+        """
+        with self._lock:
+            for start, angle in reversed(self._targets):
+                if start <= timestamp:
+                    return angle
+        return None
+
+
+class AcquisitionPipeline:
+    """
+    Background reader delivering TOF results as soon as they are latched.
+    
+    The sensor keeps ranging back to back while the pipeline runs; each
+    result is timestamped, recorded in the timeline and passed to the
+    data-ready callbacks from the reader thread.
+    """
+    
+    def __init__(self, tof: TOFSensor, timeline: Optional[AcquisitionTimeline] = None):
+        """
+        Initialize the pipeline.
+        
+        Args:
+            tof: Initialized TOF sensor in continuous ranging
+            timeline: Timeline to record integrations in (default: a new one)
+        """
+        self.tof = tof
+        self.timeline = timeline or AcquisitionTimeline()
+        self._callbacks: List[Callable[[TOFReading], None]] = []
+        self._failure_callbacks: List[Callable[[], None]] = []
+        self._thread: Optional[threading.Thread] = None
+        self._running = threading.Event()
+        self._last_ready: Optional[float] = None
+        self._delay: Optional[float] = None
+    
+    def on_reading(self, callback: Callable[[TOFReading], None]):
+        """Register a data-ready callback (called from the reader thread)."""
+        self._callbacks.append(callback)
+    
+    def on_failure(self, callback: Callable[[], None]):
+        """Register a callback for the reader stopping on a sensor error (called from the reader thread)."""
+        self._failure_callbacks.append(callback)
+    
+    def start(self, delay: Optional[float] = None):
+        """
+        Start collecting readings.
+        
+        Args:
+            delay: If given, restart the sensor's ranging this long after
+                   the start, so several sensors started together range
+                   staggered instead of in step
+        """
+        if self._thread is not None:
+            if self._running.is_set():
+                return
+            # Stopped without waiting: let the reader finish its last ranging
+            self._thread.join(timeout=1.0 + 2 * self.tof.measurement_period)
+        self._last_ready = None
+        self._delay = delay
+        self._running.set()
+        self._thread = self.tof.clock.start_thread(self._run)
+    
+    def stop(self, wait: bool = True):
+        """
+        Stop collecting readings.
+        
+        Readings latched from now on are dropped. The reader thread ends
+        after the ranging under way; if wait is False, the next start()
+        waits for it instead.
+        
+        Args:
+            wait: If True, wait for the reader thread to finish
+        """
+        if self._thread is None:
+            return
+        self._running.clear()
+        if wait:
+            self._thread.join(timeout=1.0 + 2 * self.tof.measurement_period)
+            self._thread = None
+    
+    @property
+    def is_running(self) -> bool:
+        """Check if the reader is running."""
+        return self._thread is not None and self._running.is_set()
+    
+    def next_ready(self) -> Optional[float]:
+        """
+        Predict when the integration under way will be latched.
+        
+        Returns:
+            Clock time, or None before the first reading
+        """
+        last_ready = self._last_ready
+        if last_ready is None:
+            return None
+        return last_ready + self.tof.measurement_period
+    
+    def _run(self):
+        """Reader thread: wait for each result and dispatch it."""
+        half = self.tof.integration_time / 2
+        try:
+            if self._delay is not None:
+                self.tof.clock.sleep(self._delay)
+                self.tof.restart_ranging()
+            self._read_loop(half)
+        except Exception as e:
+            logger.error(f"TOF acquisition stopped: {e}")
+            self._running.clear()
+            for callback in self._failure_callbacks:
+                try:
+                    callback()
+                except Exception as e:
+                    logger.error(f"Error in acquisition failure callback: {e}")
+    
+    def _read_loop(self, half: float):
+        """Read and dispatch results until stopped."""
+        while self._running.is_set():
+            distance, mid = self.tof.read_distance_timed()
+            if not self._running.is_set():
+                break
+            
+            reading = TOFReading(distance, mid - half, mid + half)
+            self._last_ready = reading.integration_end
+            self.timeline.record('integration', reading.integration_start, reading.integration_end)
+            
+            for callback in self._callbacks:
+                try:
+                    callback(reading)
+                except Exception as e:
+                    logger.error(f"Error in reading callback: {e}")
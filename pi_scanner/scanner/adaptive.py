@@ -0,0 +1,170 @@
+"""
+Refinement pass of adaptive scans.
+
+An adaptive ScanPlan first surveys its window at the coarse steps. Most of
+a room is smooth wall, floor and ceiling, where the coarse samples already
+describe the surface; detail is lost only at depth edges. This module finds
+those regions in the coarse range image and schedules a second pass that
+scans only them at the fine step.
+"""
+
+import logging
+from typing import List
+import numpy as np
+
+from .range_image import RangeImage
+from .scan_plan import ScanPlan, MotionSchedule, MotionStep, ScanRow
+from ..config import SERVO_TRAVEL_TIME
+
+logger = logging.getLogger(__name__)
+
+
+def find_refine_cells(ranges: np.ndarray, wrap: bool, threshold: float) -> np.ndarray:
+    """
+    Flag samples of a coarse survey that sit on a depth edge.
+    
+    A sample is flagged if the second difference of range along either
+    axis, relative to its own range, exceeds the threshold. Unlike the
+    first difference this stays small on planes seen at an angle, so an
+    oblique wall is not refined but the corner where two walls meet is.
+    Samples next to a sample with a different return status (hit vs. no
+    return) are flagged too; the edges of the window are not.
+    
+    Args:
+        ranges: Coarse ranges (rows x cols, mm); NaN where nothing returned
+        wrap: True if the columns cover the whole circle
+        threshold: Relative second difference that marks an edge
+    
+    Returns:
+        Boolean array of the same shape, True where to refine
+    """
+    ranges = np.asarray(ranges, dtype=np.float64)
+    valid = ~np.isnan(ranges)
+    flagged = np.zeros(ranges.shape, dtype=bool)
+    
+    # Rows never wrap; columns do on a full circle
+    padded = np.pad(ranges, ((1, 1), (0, 0)), constant_values=np.nan)
+    if wrap:
+        padded = np.pad(padded, ((0, 0), (1, 1)), mode='wrap')
+    else:
+        padded = np.pad(padded, ((0, 0), (1, 1)), constant_values=np.nan)
+    centre = padded[1:-1, 1:-1]
+    
+    with np.errstate(invalid='ignore', divide='ignore'):
+        along_theta = np.abs(padded[:-2, 1:-1] - 2 * centre + padded[2:, 1:-1]) / centre
+        along_phi = np.abs(padded[1:-1, :-2] - 2 * centre + padded[1:-1, 2:]) / centre
+        # Comparisons with NaN are False, so missing neighbours never flag
+        flagged |= along_theta > threshold
+        flagged |= along_phi > threshold
+    
+    # Hit / no-return boundaries, within the window
+    step = valid[1:, :] != valid[:-1, :]
+    flagged[1:, :] |= step
+    flagged[:-1, :] |= step
+    step = valid[:, 1:] != valid[:, :-1]
+    flagged[:, 1:] |= step
+    flagged[:, :-1] |= step
+    if wrap and ranges.shape[1] > 1:
+        seam = valid[:, 0] != valid[:, -1]
+        flagged[:, 0] |= seam
+        flagged[:, -1] |= seam
+    
+    return flagged
+
+
+def _owners(count: int, factor: int, coarse: int, wrap: bool) -> np.ndarray:
+    """Map fine indices to the nearest coarse sample index."""
+    owner = np.rint(np.arange(count) / factor).astype(np.int64)
+    if wrap:
+        return owner % coarse
+    return np.minimum(owner, coarse - 1)
+
+
+def flag_survey(plan: ScanPlan, range_image: RangeImage) -> np.ndarray:
+    """
+    Flag the coarse samples of an adaptive plan's survey that need refining.
+    
+    Args:
+        plan: Adaptive plan whose coarse survey is in range_image
+        range_image: Range image on the plan's fine grid
+    
+    Returns:
+        Boolean array (coarse servo angles x coarse stepper angles in scan
+        order), True where to refine
+    """
+    fine = plan.fine_plan()
+    thetas = fine.servo_angles()
+    phis = fine.stepper_angles()
+    k_theta = int(round(plan.theta_step / plan.refine_step))
+    k_phi = int(round(plan.phi_step / plan.refine_step))
+    
+    # Gather the window from the image (columns in scan order)
+    rows = [range_image.cell_index(theta, 0.0)[0] for theta in thetas]
+    cols = [range_image.cell_index(thetas[0], phi)[1] for phi in phis]
+    window = np.ix_(rows, cols)
+    ranges = range_image.get_ranges()[window].astype(np.float64)
+    ranges[range_image.get_counts()[window] == 0] = np.nan
+    
+    coarse = ranges[::k_theta, ::k_phi]
+    return find_refine_cells(coarse, plan.full_circle, plan.refine_threshold)
+
+
+def compile_refinement(plan: ScanPlan, flagged: np.ndarray) -> MotionSchedule:
+    """
+    Schedule the fine pass of an adaptive plan from its flagged survey samples.
+    
+    Every flagged coarse sample hands its neighbourhood (the fine cells
+    closer to it than to any other coarse sample) to the fine pass, except
+    the positions the survey already measured. The pass visits the fine
+    columns in scan order with one servo sweep per contiguous run of cells,
+    alternating the sweep direction from column to column.
+    
+    Args:
+        plan: Adaptive plan
+        flagged: Coarse samples to refine (see flag_survey)
+    
+    Returns:
+        MotionSchedule of the refinement (no rows if nothing to refine)
+    """
+    fine = plan.fine_plan()
+    thetas = fine.servo_angles()
+    phis = fine.stepper_angles()
+    k_theta = int(round(plan.theta_step / plan.refine_step))
+    k_phi = int(round(plan.phi_step / plan.refine_step))
+    
+    owner_theta = _owners(len(thetas), k_theta, flagged.shape[0], False)
+    owner_phi = _owners(len(phis), k_phi, flagged.shape[1], plan.full_circle)
+    refine = flagged[owner_theta[:, None], owner_phi[None, :]]
+    refine[::k_theta, ::k_phi] = False
+    
+    logger.info(f"Refining {int(flagged.sum())}/{flagged.size} coarse samples "
+                f"({int(refine.sum())} fine cells)")
+    
+    schedule_rows: List[ScanRow] = []
+    cycle = 0
+    for j, phi in enumerate(phis):
+        column = refine[:, j]
+        if not column.any():
+            continue
+        
+        # Contiguous runs of cells to refine along the servo axis
+        edges = np.flatnonzero(np.diff(np.concatenate(([0], column.astype(np.int8), [0]))))
+        runs = [list(range(start, end)) for start, end in zip(edges[::2], edges[1::2])]
+        if cycle % 2 == 1:
+            runs = [run[::-1] for run in runs[::-1]]
+        
+        previous = None
+        for run in runs:
+            if previous is None:
+                first_dwell = plan.end_dwell
+            else:
+                # Skipping over measured cells: travel time, at most a reversal
+                gap = abs(thetas[run[0]] - previous)
+                first_dwell = min(plan.end_dwell, plan.settle + gap * SERVO_TRAVEL_TIME)
+            steps = [MotionStep(thetas[i], phi, first_dwell if n == 0 else plan.settle)
+                     for n, i in enumerate(run)]
+            schedule_rows.append(ScanRow('servo', cycle, steps))
+            previous = thetas[run[-1]]
+        cycle += 1
+    
+    return MotionSchedule(schedule_rows, cycle)
@@ -3,27 +3,58 @@ Scan coordinator that orchestrates hardware components and collects point cloud
 """
 
 import logging
+import os
+import queue
 import threading
-import time
+from collections import deque
+from functools import partial
+from datetime import datetime
 from enum import Enum
 from typing import Optional, Callable, List
-from dataclasses import dataclass
+from dataclasses import dataclass, replace
+import numpy as np
 
-from ..hardware import TOFSensor, ServoController, StepperMotor
-from .point_cloud import PointCloud, Point3D
+from ..hardware import (
+    TOFSensor, TOFSensorArray, ServoController, StepperMotor, Clock, SYSTEM_CLOCK,
+    AcquisitionEvent, AcquisitionRecorder, AcquisitionLog,
+    SubField, FULL_FIELD, sub_field_grid, steer_angles,
+    ReplayTOFSensor, ReplayServoController, ReplayStepperMotor
+)
+from .point_cloud import PointCloud, PointBatch, CloudStats
+from .range_image import RangeImage
+from .direction_table import DirectionTable, KinematicModel
+from .acquisition import AcquisitionPipeline, AcquisitionTimeline, MotionLog, TOFReading
+from .scan_plan import ScanPlan, MotionSchedule, MotionStep, ScanRow
+from .adaptive import flag_survey, compile_refinement
+from .scan_control import ScanControl
+from .scan_journal import ScanJournal, Checkpoint, recover_journal
 from ..config import (
     SCAN_SERVO_START,
-    SCAN_SERVO_END,
-    SCAN_STEPPER_TOTAL,
-    SCAN_DELAY_AT_ENDS,
+    SCAN_CONTINUOUS,
+    SCAN_SWEEP_VELOCITY,
+    SCAN_PIPELINED,
     SERVO_SETTLE_TIME,
-    STEPPER_DEGREES_PER_INCREMENT,
+    SERVO_COMMAND_LATENCY,
     WEBSOCKET_BATCH_SIZE,
-    WEBSOCKET_BATCH_INTERVAL
+    WEBSOCKET_BATCH_INTERVAL,
+    POINT_CLOUD_MAX_POINTS,
+    POINT_CLOUD_SPILL,
+    EXPORT_DIRECTORY,
+    SIMULATION_SCENE,
+    ACQUISITION_RECORD,
+    SCAN_JOURNAL,
+    SCAN_JOURNAL_FILE,
+    TOF_ROI_SCAN
 )
 
 logger = logging.getLogger(__name__)
 
+# Longest wait for a reading from the acquisition pipeline (seconds)
+READING_TIMEOUT = 1.0
+
+# Slack on either side of a pipelined servo move for latch timing jitter (seconds)
+PIPELINE_MARGIN = 0.005
+
 
 class ScanState(Enum):
     """Scanner state enumeration."""
@@ -43,6 +74,10 @@ class ScanProgress:
     points_collected: int
     current_cycle: int
     total_cycles: int
+    stats: Optional[CloudStats] = None
+    theta_resolution: Optional[float] = None  # Widest servo gap scanned so far (degrees)
+    phi_resolution: Optional[float] = None    # Widest stepper gap scanned so far (degrees)
+    resumable: bool = False                   # An interrupted scan can be resumed from the journal
     
     def to_dict(self) -> dict:
         """Convert to dictionary for JSON serialization."""
@@ -53,7 +88,11 @@ class ScanProgress:
             'points_collected': self.points_collected,
             'current_cycle': self.current_cycle,
             'total_cycles': self.total_cycles,
-            'progress_percent': (self.current_cycle / self.total_cycles * 100) if self.total_cycles > 0 else 0
+            'progress_percent': (self.current_cycle / self.total_cycles * 100) if self.total_cycles > 0 else 0,
+            'theta_resolution': self.theta_resolution,
+            'phi_resolution': self.phi_resolution,
+            'resumable': self.resumable,
+            'stats': self.stats.to_dict() if self.stats is not None else None
         }
 
 
@@ -61,50 +100,235 @@ class ScanCoordinator:
     """
     Coordinates the scanning process across all hardware components.
     
-    Scan pattern:
-    1. Servo sweeps from 0° to 180° (taking TOF readings at each degree)
-    2. Servo sweeps back from 180° to 0°
-    3. Stepper rotates 1° (or configured increment)
-    4. Repeat until stepper completes 360°
+    What is scanned comes from a ScanPlan (elevation/azimuth windows, step
+    sizes and order), compiled into a motion schedule of rows. The default
+    plan covers the full hemisphere at 1° steps:
+    - raster: the servo sweeps 0° to 180° and back at every stepper angle
+    - serpentine: the stepper rotates at both ends of the servo range, so
+      each sweep (alternately 0° to 180° and back) covers a new stepper
+      angle and the scan takes about half as long
+    - spiral: the stepper turns through the azimuth window at every servo
+      angle, always in the same direction
+    - progressive: serpentine sweeps at stepper angles in coarse-to-fine
+      order, so a low-resolution picture of the whole scene arrives early;
+      progress reports the effective resolution reached so far
+    
+    In continuous mode the servo moves at constant velocity through each
+    sweep while the sensor ranges back to back, and every reading gets the
+    servo angle at the middle of its integration. In pipelined (stepped)
+    mode the servo still stops at every degree, but moves between rangings
+    while the sensor keeps integrating.
+    
+    An adaptive plan runs in two passes: the schedule above at the plan's
+    coarse steps, then a refinement at the fine step of only the regions
+    where the coarse survey found depth edges.
+    
+    With several TOF sensors on the servo arm (TOF_SENSORS), the main one
+    drives the scan as above while all of them range in the background:
+    staggered across the measurement period in continuous sweeps, in step
+    in stepped ones so that they all integrate while the servo rests.
+    Readings of the other sensors taken while the beam stood still (or
+    during a continuous sweep) are added at the pose of the moment plus
+    the sensor's direction offsets.
+    
+    In sub-field mode the main sensor ranges a grid of regions of interest
+    of its SPAD array at every pose, each steering the beam to a different
+    direction inside the field of view, so one servo settle or stepper
+    increment yields several readings. Sweeps are then stepped, with the
+    sensor read directly.
     """
     
-    def __init__(self, simulate: bool = False):
+    def __init__(self, simulate: bool = False, spill: bool = POINT_CLOUD_SPILL,
+                 clock: Clock = SYSTEM_CLOCK, replay: Optional[AcquisitionLog] = None,
+                 journal: bool = SCAN_JOURNAL):
         """
         Initialize the scan coordinator.
         
         Args:
             simulate: If True, run in simulation mode without real hardware
+            spill: If True, keep every point in memory-mapped files under
+                   EXPORT_DIRECTORY instead of dropping the oldest ones
+            clock: Time source of the scan and the hardware; a VirtualClock
+                   runs simulated scans faster than real time
+            replay: Recorded acquisition session to play back instead of
+                    using the hardware; its scan settings are applied
+            journal: If True, journal every scan under EXPORT_DIRECTORY so
+                     an interrupted one can be resumed
         """
         self.simulate = simulate
+        self.clock = clock
+        self.replay = replay
         
         # Hardware components
-        self.tof = TOFSensor(simulate=simulate)
-        self.servo = ServoController(simulate=simulate)
-        self.stepper = StepperMotor(simulate=simulate)
+        if replay is not None:
+            self.sensors = TOFSensorArray([ReplayTOFSensor(replay, clock=clock)])
+            self.servo = ReplayServoController(clock=clock)
+            self.stepper = ReplayStepperMotor(clock=clock)
+        else:
+            self.sensors = TOFSensorArray.from_config(simulate=simulate, clock=clock)
+            self.servo = ServoController(simulate=simulate, clock=clock)
+            self.stepper = StepperMotor(simulate=simulate, clock=clock)
+        self.tof: TOFSensor = self.sensors.main
+        
+        # What to scan; replaced by start_scan(plan)
+        self.plan = ScanPlan()
+        self._schedule: Optional[MotionSchedule] = None
+        self._grid = self.plan.grid()
+        
+        # Point cloud buffer, with an organized (servo x stepper) range image
+        self.point_cloud = PointCloud(
+            max_points=POINT_CLOUD_MAX_POINTS,
+            range_image=RangeImage(**self._grid),
+            spill_directory=EXPORT_DIRECTORY if spill else None
+        )
+        
+        # Kinematic model of the scanner head; replace with calibrated values
+        # before start_scan() to correct for mounting errors
+        self.kinematic_model = KinematicModel()
+        self._direction_table: Optional[DirectionTable] = None
+        
+        # Simulated readings come from a scene, along the beam the servo
+        # and stepper point at
+        if simulate and replay is None:
+            self._load_simulation_scene(SIMULATION_SCENE)
+        
+        # Journal of raw acquisition events, one recording per scan
+        self.record_acquisition = ACQUISITION_RECORD
+        self._recorder: Optional[AcquisitionRecorder] = None
+        self.tof.on_raw_reading(self._record_raw)
+        
+        # Append-only journal of the scan, to resume it after a crash
+        self.journal_path: Optional[str] = (
+            os.path.join(EXPORT_DIRECTORY, SCAN_JOURNAL_FILE) if journal else None)
+        self._journal: Optional[ScanJournal] = None
+        self._resume_at: Optional[Checkpoint] = None
+        # Flagged survey samples of a journalled refinement to resume
+        self._resume_refinement: Optional[np.ndarray] = None
+        # Whether the journal holds an unfinished scan (None: not checked yet)
+        self._resumable: Optional[bool] = None
+        self._scanned = False  # A scan has run in this process
+        
+        # Sweep with continuous servo motion instead of stop-settle-read
+        self.continuous_sweep = SCAN_CONTINUOUS
+        # Overlap integration with servo motion in stepped sweeps
+        self.pipelined = SCAN_PIPELINED
+        # Range a grid of SPAD regions of interest at every pose
+        self.sub_field_scan = TOF_ROI_SCAN
+        try:
+            self.sub_fields: List[SubField] = sub_field_grid()
+        except ValueError as e:
+            logger.error(f"Invalid TOF ROI grid, sub-field scans use the full field: {e}")
+            self.sub_fields = [FULL_FIELD]
+        
+        # Background acquisition; readings are queued for the scan thread
+        self.timeline = AcquisitionTimeline()
+        self.acquisition = AcquisitionPipeline(self.tof, self.timeline)
+        self._readings = clock.queue()
+        self.acquisition.on_reading(self._readings.put)
+        # A reader stopped by a sensor error wakes the wait at once
+        self.acquisition.on_failure(lambda: self._readings.put(None))
         
-        # Point cloud buffer
-        self.point_cloud = PointCloud()
+        # Readings of the other sensors, folded in as they arrive; moves
+        # are logged to reject the ones taken while the beam moved
+        self.motion = MotionLog()
+        self._extra_acquisition: List[AcquisitionPipeline] = []
+        self._extra_readings = deque()
         
         # State
         self._state = ScanState.IDLE
         self._scan_thread: Optional[threading.Thread] = None
-        self._stop_requested = threading.Event()
-        self._pause_requested = threading.Event()
+        # Pause/resume/stop commands; they also wake a wait for a reading
+        self.control = ScanControl(clock=clock)
+        self.control.on_request(lambda: self._readings.put(None))
         
         # Progress tracking
         self._current_servo_angle = 0.0
         self._current_stepper_angle = 0.0
         self._current_cycle = 0
-        self._total_cycles = int(SCAN_STEPPER_TOTAL / STEPPER_DEGREES_PER_INCREMENT)
+        self._total_cycles = len(self.plan.stepper_angles())
+        self._theta_coverage, self._phi_coverage = self.plan.coverage()
         
         # Callbacks for real-time updates
         self._on_progress: List[Callable[[ScanProgress], None]] = []
-        self._on_points: List[Callable[[List[Point3D]], None]] = []
+        self._on_points: List[Callable[[PointBatch], None]] = []
         self._on_state_change: List[Callable[[ScanState], None]] = []
         
-        # Point batching for efficient WebSocket transmission
-        self._point_batch: List[Point3D] = []
-        self._last_batch_time = time.time()
+        # Readings waiting to be added to the cloud as one batch
+        self._pending_theta: List[float] = []
+        self._pending_phi: List[float] = []
+        self._pending_distance: List[int] = []
+        self._last_batch_time = self.clock.monotonic()
+        
+        if replay is not None:
+            self._apply_session_settings(replay.metadata)
+            self.tof.set_position_source(self._commanded_position)
+    
+    def _apply_session_settings(self, metadata: dict):
+        """Scan like a recorded or journalled session (plan, sweep mode, kinematic model)."""
+        try:
+            if 'plan' in metadata:
+                self.plan = ScanPlan.from_dict(metadata['plan'])
+            if 'kinematic_model' in metadata:
+                self.kinematic_model = KinematicModel(**metadata['kinematic_model'])
+        except (TypeError, ValueError) as e:
+            logger.warning(f"Ignoring session scan settings: {e}")
+        self.continuous_sweep = metadata.get('continuous_sweep', self.continuous_sweep)
+        self.pipelined = metadata.get('pipelined', self.pipelined)
+        self.sub_field_scan = metadata.get('sub_field_scan', self.sub_field_scan)
+        try:
+            if 'sub_fields' in metadata:
+                self.sub_fields = [SubField(**field) for field in metadata['sub_fields']]
+        except TypeError as e:
+            logger.warning(f"Ignoring session ROI grid: {e}")
+    
+    def _session_metadata(self) -> dict:
+        """Describe the scan for the header of an acquisition recording or scan journal."""
+        return {
+            'plan': self.plan.to_dict(),
+            'continuous_sweep': self.continuous_sweep,
+            'pipelined': self.pipelined,
+            'sub_field_scan': self.sub_field_scan,
+            'sub_fields': [field.to_dict() for field in self.sub_fields],
+            'integration_time': self.tof.integration_time,
+            'sensors': self.sensors.to_dict(),
+            'kinematic_model': self.kinematic_model.to_dict(),
+            'simulated': self.simulate,
+            'started': datetime.now().isoformat()
+        }
+    
+    def _commanded_position(self, timestamp: float):
+        """Get the commanded (servo angle, stepper steps) at a clock time."""
+        steps = int(round(self.stepper.get_angle() * self.stepper.steps_per_degree))
+        return self.servo.angle_at(timestamp), steps
+    
+    def _record_raw(self, distance: int, status: int, timestamp: float):
+        """Journal one raw ranging while recording (reading thread)."""
+        recorder = self._recorder
+        if recorder is None:
+            return
+        servo_angle, stepper_steps = self._commanded_position(timestamp)
+        recorder.record(AcquisitionEvent(timestamp, servo_angle, stepper_steps, distance, status))
+    
+    def _load_simulation_scene(self, name: str):
+        """Range the simulated TOF sensor against a named scene."""
+        # Imported here: the simulation package builds on scanner modules
+        from ..simulation import load_scene
+        
+        scene = load_scene(name)
+        if scene is None:
+            logger.warning("Simulated TOF sensor falls back to a fixed distance")
+            return
+        for sensor in self.sensors.sensors:
+            sensor.set_simulation_scene(scene, partial(self._simulated_beam, sensor))
+        logger.info(f"Simulating scene '{name}'")
+    
+    def _simulated_beam(self, sensor: TOFSensor, timestamp: float):
+        """Get a simulated sensor's beam (origin, direction) at a clock time."""
+        field = sensor.sub_field
+        theta, phi = steer_angles(self.servo.angle_at(timestamp) + sensor.theta_offset,
+                                  self.stepper.get_angle() + sensor.phi_offset,
+                                  field.along, field.across)
+        return self.kinematic_model.rays(theta, phi)
     
     def initialize(self) -> bool:
         """
@@ -116,7 +340,7 @@ class ScanCoordinator:
         logger.info("Initializing scanner hardware...")
         
         # Initialize each component
-        if not self.tof.initialize():
+        if not self.sensors.initialize():
             logger.error("Failed to initialize TOF sensor")
             self._set_state(ScanState.ERROR)
             return False
@@ -135,10 +359,13 @@ class ScanCoordinator:
         self._set_state(ScanState.IDLE)
         return True
     
-    def start_scan(self) -> bool:
+    def start_scan(self, plan: Optional[ScanPlan] = None) -> bool:
         """
         Start the scanning process in a background thread.
         
+        Args:
+            plan: What to scan (default: the plan of the previous scan)
+        
         Returns:
             True if scan started successfully
         """
@@ -150,13 +377,149 @@ class ScanCoordinator:
             logger.error("Scanner in error state, cannot start")
             return False
         
+        self._prepare_scan(plan)
+        self._resume_at = None
+        self._resume_refinement = None
+        if self.journal_path is not None:
+            try:
+                self._journal = ScanJournal(self.journal_path, self._session_metadata())
+            except OSError as e:
+                logger.error(f"Failed to start scan journal: {e}")
+        return self._launch_scan()
+    
+    def resume_from_journal(self, path: Optional[str] = None) -> bool:
+        """
+        Continue a scan that was interrupted (crash, power loss or stop).
+        
+        The cloud is rebuilt from the readings in the scan journal up to its
+        last checkpoint, and the scan carries on from the row after it with
+        the journalled plan and settings. After a restart the stepper is
+        assumed to stand where the checkpoint left it.
+        
+        Args:
+            path: Journal to resume (default: the scan journal)
+        
+        Returns:
+            True if the scan was resumed
+        """
+        if self._state != ScanState.IDLE:
+            logger.warning("Scanner busy, cannot resume from journal")
+            return False
+        
+        path = path or self.journal_path
+        if path is None:
+            logger.error("Scan journal disabled")
+            return False
+        recovered = recover_journal(path)
+        if recovered is None:
+            return False
+        if recovered.complete:
+            logger.info("Journalled scan already complete, nothing to resume")
+            return False
+        
+        self._apply_session_settings(recovered.metadata)
+        checkpoint = recovered.checkpoint
+        if checkpoint is not None and not self._scanned and self.stepper.is_initialized:
+            self.stepper.set_position(checkpoint.stepper_angle)
+        
+        self.point_cloud.clear()
+        self._prepare_scan(None)
+        batch = self.point_cloud.add_batch(recovered.theta, recovered.phi, recovered.distance)
+        if batch is not None:
+            for callback in self._on_points:
+                try:
+                    callback(batch)
+                except Exception as e:
+                    logger.error(f"Error in points callback: {e}")
+        
+        try:
+            self._journal = ScanJournal(path, offset=recovered.end_offset)
+        except OSError as e:
+            logger.error(f"Failed to continue scan journal: {e}")
+        self._resume_at = checkpoint
+        self._resume_refinement = recovered.refinement
+        if checkpoint is not None:
+            logger.info(f"Resuming scan at cycle {checkpoint.cycle} "
+                        f"(phase {checkpoint.phase}, {checkpoint.rows} rows done)")
+        return self._launch_scan()
+    
+    @property
+    def resumable(self) -> bool:
+        """Check if the scan journal holds an unfinished scan to resume."""
+        if self._resumable is None:
+            recovered = None
+            if self.journal_path is not None and os.path.exists(self.journal_path):
+                recovered = recover_journal(self.journal_path)
+            self._resumable = recovered is not None and not recovered.complete
+        return self._resumable
+    
+    def discard_journal(self):
+        """Delete the scan journal, so the scan in it cannot be resumed."""
+        if self._scan_thread is not None and self._scan_thread.is_alive():
+            logger.warning("Scanner busy, cannot discard scan journal")
+            return
+        if self.journal_path is not None:
+            try:
+                os.remove(self.journal_path)
+            except FileNotFoundError:
+                pass
+            except OSError as e:
+                logger.error(f"Failed to delete scan journal: {e}")
+                return
+        self._resumable = False
+    
+    def _prepare_scan(self, plan: Optional[ScanPlan]):
+        """
+        Set up the plan, schedule and storage of a scan.
+        
+        Args:
+            plan: What to scan (default: the current plan)
+        """
         # Reset stop flag
-        self._stop_requested.clear()
-        self._pause_requested.clear()
+        self.control.reset()
+        self.timeline.clear()
+        
+        if plan is not None:
+            self.plan = plan
+        self._schedule = self.plan.compile()
+        self._total_cycles = self._schedule.cycles
+        logger.info(f"Scan plan: {len(self._schedule)} readings, {self.plan.to_dict()}")
+        if self.sub_field_scan:
+            along = [field.along for field in self.sub_fields]
+            across = [field.across for field in self.sub_fields]
+            logger.info(f"Sub-field scan: {len(self.sub_fields)} readings per pose over "
+                        f"{max(along) - min(along):.1f} x {max(across) - min(across):.1f} degrees")
+        
+        # Organized storage follows the plan's grid
+        grid = self.plan.grid()
+        if grid != self._grid:
+            self.point_cloud.range_image = RangeImage(**grid)
+            self._grid = grid
+            self._direction_table = None
+        
+        # Build the direction table for this scan once, up front
+        if self._direction_table is None or self._direction_table.model != self.kinematic_model:
+            self._direction_table = DirectionTable(**grid, model=replace(self.kinematic_model))
+            self.point_cloud.set_direction_table(self._direction_table)
+    
+    def _launch_scan(self) -> bool:
+        """
+        Start the scan thread on the prepared scan.
+        
+        Returns:
+            True
+        """
+        self._scanned = True
+        if self.replay is not None:
+            self.tof.rewind()
+        if self.record_acquisition:
+            try:
+                self._recorder = AcquisitionRecorder(self._session_metadata())
+            except OSError as e:
+                logger.error(f"Failed to start acquisition recording: {e}")
         
         # Start scan thread
-        self._scan_thread = threading.Thread(target=self._scan_loop, daemon=True)
-        self._scan_thread.start()
+        self._scan_thread = self.clock.start_thread(self._scan_loop)
         
         logger.info("Scan started")
         return True
@@ -166,21 +529,20 @@ class ScanCoordinator:
         if self._state in (ScanState.SCANNING, ScanState.PAUSED):
             logger.info("Stop requested")
             self._set_state(ScanState.STOPPING)
-            self._stop_requested.set()
-            self._pause_requested.set()  # Release from pause if paused
+            self.control.request_stop()  # Also releases a pause
     
     def pause_scan(self):
         """Pause the current scan."""
         if self._state == ScanState.SCANNING:
             logger.info("Pause requested")
-            self._pause_requested.set()
+            self.control.request_pause()
             self._set_state(ScanState.PAUSED)
     
     def resume_scan(self):
         """Resume a paused scan."""
         if self._state == ScanState.PAUSED:
             logger.info("Resume requested")
-            self._pause_requested.clear()
+            self.control.request_resume()
             self._set_state(ScanState.SCANNING)
     
     def reset(self):
@@ -191,8 +553,9 @@ class ScanCoordinator:
         if self._scan_thread is not None:
             self._scan_thread.join(timeout=5.0)
         
-        # Clear point cloud
+        # Clear point cloud; the scan cannot be resumed any more
         self.point_cloud.clear()
+        self.discard_journal()
         
         # Reset positions
         self._current_servo_angle = 0.0
@@ -213,133 +576,691 @@ class ScanCoordinator:
     def _scan_loop(self):
         """Main scan loop running in background thread."""
         self._set_state(ScanState.SCANNING)
-        self._current_cycle = 0
-        self._current_stepper_angle = 0.0
+        resume = self._resume_at
+        resume_refinement = self._resume_refinement
+        self._resume_at = None
+        self._resume_refinement = None
+        self._current_cycle = resume.cycle if resume is not None else 0
+        self._current_stepper_angle = self.stepper.get_angle()
+        self._theta_coverage, self._phi_coverage = self.plan.coverage()
         
         try:
-            while not self._stop_requested.is_set():
-                # Check for pause
-                while self._pause_requested.is_set() and not self._stop_requested.is_set():
-                    time.sleep(0.1)
-                
-                if self._stop_requested.is_set():
-                    break
-                
-                # Perform one complete servo sweep cycle
-                self._perform_servo_sweep()
-                
-                # Check stop flag again
-                if self._stop_requested.is_set():
-                    break
-                
-                # Increment stepper
-                self._current_stepper_angle = self.stepper.increment()
-                self._current_cycle += 1
-                
-                # Notify progress
-                self._notify_progress()
-                
-                # Check if full rotation complete
-                if self._current_stepper_angle >= SCAN_STEPPER_TOTAL or \
-                   self._current_cycle >= self._total_cycles:
-                    logger.info("Full 360° scan complete!")
-                    break
+            self._start_acquisition()
+            
+            complete = True
+            if resume is None or resume.phase == 0:
+                complete = self._run_schedule(
+                    self._schedule, start_row=resume.rows if resume is not None else 0)
+                resume = None
+            if complete and self.plan.adaptive:
+                if resume is None:
+                    complete = self._refine()
+                else:
+                    complete = self._refine(resume.rows, resume_refinement)
+            if complete:
+                logger.info("Scan plan complete!")
+                self._journal_call('complete')
             
         except Exception as e:
             logger.error(f"Error in scan loop: {e}")
             self._set_state(ScanState.ERROR)
         finally:
+            self.acquisition.stop()
+            for pipeline in self._extra_acquisition:
+                pipeline.stop()
+            self._extra_acquisition = []
+            self.tof.set_sub_field(FULL_FIELD)
+            if self._recorder is not None:
+                self._recorder.close()
+                self._recorder = None
+            
             # Flush any remaining points
             self._flush_point_batch()
+            self._journal_call('close')
+            self._journal = None
+            self._resumable = None
             
             if self._state != ScanState.ERROR:
                 self._set_state(ScanState.IDLE)
             
             logger.info(f"Scan finished. Total points: {self.point_cloud.get_point_count()}")
     
-    def _perform_servo_sweep(self):
-        """Perform one complete servo sweep (0→180→0) with TOF readings."""
-        # Forward sweep: 0 → 180
-        for angle in range(SCAN_SERVO_START, SCAN_SERVO_END + 1):
-            if self._stop_requested.is_set():
+    def _run_schedule(self, schedule: MotionSchedule, first_cycle: int = 0,
+                      track_coverage: bool = True, phase: int = 0,
+                      start_row: int = 0) -> bool:
+        """
+        Execute the rows of a motion schedule.
+        
+        Args:
+            schedule: Schedule to execute
+            first_cycle: Progress cycle of the schedule's cycle 0
+            track_coverage: If True, the rows count towards the effective
+                            resolution reported in progress
+            phase: Scan phase journalled with the checkpoints (see Checkpoint)
+            start_row: First row to scan; earlier rows were scanned before
+                       the scan was resumed
+        
+        Returns:
+            True if every row was scanned, False if the scan was stopped
+        """
+        rows = schedule.rows
+        if track_coverage:
+            for row in rows[:start_row]:
+                for step in row.steps:
+                    self._theta_coverage.add(step.servo)
+                    self._phi_coverage.add(step.stepper)
+        
+        for i in range(start_row, len(rows)):
+            row = rows[i]
+            if not self._hold_while_paused():
+                return False
+            
+            self._scan_row(row)
+            
+            # Check stop flag again
+            if not self.control.check():
+                return False
+            
+            # Hand the row to the cloud
+            self._flush_point_batch()
+            if track_coverage:
+                for step in row.steps:
+                    self._theta_coverage.add(step.servo)
+                    self._phi_coverage.add(step.stepper)
+            cycle = rows[i + 1].cycle if i + 1 < len(rows) else schedule.cycles
+            self._current_cycle = first_cycle + cycle
+            self._journal_call('checkpoint', Checkpoint(
+                phase, i + 1, self._current_cycle, self.stepper.get_angle()))
+            
+            # Notify progress
+            self._notify_progress()
+        return True
+    
+    def _refine(self, start_row: int = 0, flagged: Optional[np.ndarray] = None) -> bool:
+        """
+        Run the fine pass of an adaptive plan over the coarse survey.
+        
+        Args:
+            start_row: First row of the refinement to scan (when resumed)
+            flagged: Survey samples the resumed refinement was started with
+                     (default: flag them in the range image and journal them)
+        
+        Returns:
+            True if the refinement was scanned, False if the scan was stopped
+        """
+        self._flush_point_batch()
+        if flagged is None:
+            if start_row > 0:
+                logger.warning("Journal holds no refinement; re-flagging the survey")
+            # Refinement readings land in the image too, so a resumed
+            # refinement replays the journalled flags instead
+            flagged = flag_survey(self.plan, self.point_cloud.range_image)
+            if start_row == 0:
+                self._journal_call('refinement', flagged)
+        refinement = compile_refinement(self.plan, flagged)
+        logger.info(f"Coarse survey complete; refining {len(refinement)} readings "
+                    f"in {refinement.cycles} columns")
+        
+        first_cycle = self._total_cycles
+        self._total_cycles += refinement.cycles
+        self._notify_progress()
+        # Refined regions are local; the resolution stays the coarse one
+        return self._run_schedule(refinement, first_cycle, track_coverage=False,
+                                  phase=1, start_row=start_row)
+    
+    def _journal_call(self, method: str, *args):
+        """Write to the scan journal; on failure, carry on without it."""
+        if self._journal is None:
+            return
+        try:
+            getattr(self._journal, method)(*args)
+        except OSError as e:
+            logger.error(f"Scan journal failed, continuing without it: {e}")
+            self._journal = None
+    
+    def _scan_row(self, row: ScanRow):
+        """
+        Move to the first step of a schedule row and take the row's readings.
+        
+        The stepper turns during the first step's dwell (e.g. the pause at
+        the end of a servo sweep).
+        
+        Args:
+            row: Row of the motion schedule
+        """
+        first = row.steps[0]
+        started = self.clock.monotonic()
+        if not self._move_stepper(first.stepper):
+            return
+        self._command_servo(first.servo, first.dwell)
+        self._current_servo_angle = first.servo
+        
+        settled = self._wait_until(started + first.dwell)
+        self.timeline.record('settle_wait', started, self.clock.monotonic())
+        if not settled:
+            return
+        
+        if row.axis == 'stepper':
+            self._scan_stepper_row(row.steps)
+        else:
+            self._sweep(row.steps)
+    
+    def _sweep(self, steps: List[MotionStep]):
+        """
+        Sweep the servo through a row, taking TOF readings.
+        
+        Args:
+            steps: Steps at one stepper angle; the servo has settled at the first
+        """
+        # Sub-field scans range several ROIs per pose, read directly
+        if self.continuous_sweep and len(steps) > 1 and not self.sub_field_scan:
+            self._scan_continuous(steps)
+            return
+        if self.pipelined and not self.sub_field_scan:
+            self._scan_pipelined(steps)
+            return
+        
+        for i, step in enumerate(steps):
+            if not self._hold_while_paused():
                 return
             
-            # Check pause
-            while self._pause_requested.is_set() and not self._stop_requested.is_set():
-                time.sleep(0.1)
+            self._scan_at_angle(step.servo, step.dwell if i > 0 else 0.0)
+    
+    def _scan_stepper_row(self, steps: List[MotionStep]):
+        """
+        Take the readings of a stepper pass at one servo angle.
+        
+        The stepper stops at every step and the reading is taken once it
+        has rested for the step's dwell.
+        
+        Args:
+            steps: Steps at one servo angle; the stepper is at the first
+        """
+        index = 0
+        while index < len(steps):
+            if not self._hold_while_paused():
+                return
+            
+            step = steps[index]
+            if index > 0 and not self._move_stepper(step.stepper):
+                return
+            settled = self.clock.monotonic() + (step.dwell if index > 0 else 0.0)
+            
+            if self.sub_field_scan:
+                if not self._wait_until(settled) or not self._read_sub_fields(step.servo):
+                    return
+                index += 1
+                continue
+            
+            distance = self._read_at_rest(settled)
+            if self.control.interrupted():
+                # Paused or stopped before the reading: take it again
+                continue
+            if distance is not None and distance > 0:
+                self._add_reading(step.servo, distance)
+            index += 1
+    
+    def _move_stepper(self, angle: float) -> bool:
+        """
+        Turn the stepper to a scheduled angle, if it is not there yet.
+        
+        A pause halts the stepper mid-move; the move completes on resume.
+        
+        Args:
+            angle: Target angle in degrees (0-360)
+            
+        Returns:
+            True once at the angle, False if a stop was requested
+        """
+        if abs(angle - self._current_stepper_angle) < 1e-6:
+            return True
+        self.motion.begin(self.clock.monotonic())
+        try:
+            while True:
+                self.stepper.move_to_angle(angle, cancel=self.control.interrupted)
+                if not self.control.interrupted():
+                    break
+                if not self._hold_while_paused():
+                    return False
+            # Track the planned angle so readings stay on the plan's grid
+            self._current_stepper_angle = angle
+        finally:
+            self.motion.end(self.clock.monotonic())
+        return True
+    
+    def _read_at_rest(self, settled: float) -> Optional[int]:
+        """
+        Read the distance once the mechanism has come to rest.
+        
+        Args:
+            settled: Clock time from which the beam is stationary
             
-            self._scan_at_angle(angle)
+        Returns:
+            Distance in millimeters, or None if the reading failed or was
+            interrupted by a pause or stop
+        """
+        if not self.acquisition.is_running:
+            if not self.control.sleep_until(settled):
+                return None
+            return self.tof.read_distance()
+        
+        while not self.control.interrupted():
+            reading = self._wait_reading()
+            if reading is None:
+                return None
+            if reading.integration_start >= settled:
+                return reading.distance
+            self.timeline.count('discarded')
+        return None
+    
+    def _start_acquisition(self):
+        """Start background ranging for continuous or pipelined sweeps, or with several sensors."""
+        gap = 0.0
+        if self.pipelined and not (self.continuous_sweep or self.sub_field_scan):
+            # Leave the servo time to settle between rangings
+            gap = self.plan.settle - SERVO_COMMAND_LATENCY + 2 * PIPELINE_MARGIN
+        if self._background_ranging():
+            self.tof.set_measurement_gap(gap)
+        
+        self._extra_acquisition = []
+        for sensor in self.sensors.extras:
+            sensor.set_measurement_gap(gap)
+            pipeline = AcquisitionPipeline(sensor)
+            pipeline.on_reading(lambda reading, sensor=sensor: self._fold_reading(sensor, reading))
+            self._extra_acquisition.append(pipeline)
+        self._start_readers()
+    
+    def _background_ranging(self) -> bool:
+        """Check if the main sensor is read by the acquisition pipeline."""
+        if self.sub_field_scan:
+            return False
+        return self.continuous_sweep or self.pipelined or len(self.sensors) > 1
+    
+    def _start_readers(self):
+        """Start the acquisition pipelines, the other sensors staggered after the main one."""
+        # In stepped sweeps every sensor must integrate while the servo
+        # rests, so they range in step there
+        staggered = self.continuous_sweep and not self.sub_field_scan
+        step = self.tof.measurement_period / len(self.sensors) if staggered else 0.0
+        if self._background_ranging():
+            self._drain_readings()
+            self.acquisition.start(delay=0.0 if self._extra_acquisition else None)
+        for k, pipeline in enumerate(self._extra_acquisition, start=1):
+            pipeline.start(delay=k * step)
+    
+    def _stop_readers(self):
+        """Stop the acquisition pipelines without waiting for them."""
+        self.acquisition.stop(wait=False)
+        for pipeline in self._extra_acquisition:
+            pipeline.stop(wait=False)
+    
+    def _fold_reading(self, sensor: TOFSensor, reading: TOFReading):
+        """
+        Queue a reading of another sensor at its direction (reading thread).
+        
+        The reading is dropped if the mechanism moved during its
+        integration (other than in a continuous sweep), or if its direction
+        falls below the servo's 0 degrees.
+        """
+        if reading.distance is None or reading.distance <= 0:
+            return
+        if not self.motion.still(reading.integration_start, reading.integration_end):
+            return
+        servo_angle = self.motion.servo_angle(reading.mid)
+        if servo_angle is None:
+            servo_angle = self.servo.angle_at(reading.mid)
+        # A stepper move takes far longer than the hand-over of a reading,
+        # so the planned stepper angle is still the reading's
+        theta = servo_angle + sensor.theta_offset
+        phi = self._current_stepper_angle + sensor.phi_offset
+        if theta >= 0:
+            self._extra_readings.append((round(theta, 2), phi % 360, reading.distance))
+    
+    def _drain_readings(self):
+        """Drop readings queued by the acquisition pipeline."""
+        while True:
+            try:
+                self._readings.get_nowait()
+            except queue.Empty:
+                return
+    
+    def _wait_reading(self) -> Optional[TOFReading]:
+        """
+        Wait for the next reading from the acquisition pipeline.
+        
+        Returns:
+            The reading, or None if none arrived within READING_TIMEOUT,
+            the scan was paused or stopped, or the reader failed
+        """
+        waited = self.clock.monotonic()
+        deadline = waited + READING_TIMEOUT
+        while True:
+            try:
+                # None is queued to wake this wait for a command
+                reading = self._readings.get(timeout=max(0.0, deadline - self.clock.monotonic()))
+            except queue.Empty:
+                logger.warning("No TOF reading within timeout")
+                reading = None
+                break
+            if reading is not None or self.control.interrupted() or not self.acquisition.is_running:
+                break
+        self.timeline.record('sensor_wait', waited, self.clock.monotonic())
+        return reading
+    
+    def _hold_while_paused(self) -> bool:
+        """
+        Halt here while the scan is paused, with acquisition stopped.
+        
+        Returns:
+            True to carry on, False if a stop was requested
+        """
+        if self.control.paused:
+            self._stop_readers()
+            if not self.control.hold():
+                return False
+            self._start_readers()
+        return self.control.check()
+    
+    def _wait_until(self, deadline: float) -> bool:
+        """
+        Sleep until a clock time, holding in place while paused.
+        
+        Returns:
+            True once the deadline has passed, False if a stop was requested
+        """
+        while not self.control.sleep_until(deadline):
+            if not self._hold_while_paused():
+                return False
+        return True
+    
+    def _command_servo(self, angle: float, settle: float) -> float:
+        """
+        Command the servo to an angle without waiting for it.
+        
+        Args:
+            angle: Target angle in degrees
+            settle: Time the servo needs to reach and settle at the angle
+            
+        Returns:
+            Clock time of the command
+        """
+        commanded = self.clock.monotonic()
+        self.motion.add(commanded + SERVO_COMMAND_LATENCY, commanded + settle, angle)
+        self.servo.move_to(angle, smooth=False)
+        self.timeline.record('settle', commanded, commanded + settle)
+        return commanded
+    
+    def _scan_pipelined(self, steps: List[MotionStep]):
+        """
+        Stepped sweep with servo motion overlapped with sensor integration.
+        
+        The sensor ranges continuously, resting about the plan's settle time
+        minus SERVO_COMMAND_LATENCY between rangings. Once the integration under
+        way is known to see the current angle, the next angle is commanded
+        about one command latency before that integration latches, so the
+        servo moves and settles in the rest period and every integration
+        sees a stationary beam. Readings whose integration overlapped motion
+        are discarded.
+        
+        Args:
+            steps: Steps at one stepper angle; the servo has settled at the first
+        """
+        angles = [step.servo for step in steps]
         
-        # Pause at end
-        time.sleep(SCAN_DELAY_AT_ENDS)
+        # Command time of each angle still waiting for its reading; the
+        # first one is settled already
+        commanded = {0: self.clock.monotonic() - steps[0].dwell}
+        index = 0
+        self._drain_readings()
         
-        # Reverse sweep: 180 → 0
-        for angle in range(SCAN_SERVO_END, SCAN_SERVO_START - 1, -1):
-            if self._stop_requested.is_set():
+        while index < len(angles):
+            if self.control.paused:
+                if not self._hold_while_paused():
+                    return
+                commanded = {index: self._command_servo(angles[index], steps[index].dwell)}
+            elif not self.control.check():
                 return
             
-            # Check pause
-            while self._pause_requested.is_set() and not self._stop_requested.is_set():
-                time.sleep(0.1)
+            if index not in commanded:
+                commanded[index] = self._command_servo(angles[index], steps[index].dwell)
+            settled = commanded[index] + steps[index].dwell
+            
+            if index + 1 < len(angles) and index + 1 not in commanded:
+                ready = self.acquisition.next_ready()
+                if ready is not None and ready - self.tof.integration_time >= settled:
+                    # The integration under way sees this angle: move on
+                    # just before it latches
+                    waited = self.clock.monotonic()
+                    on_time = self.control.sleep_until(ready - SERVO_COMMAND_LATENCY + PIPELINE_MARGIN)
+                    self.timeline.record('latch_wait', waited, self.clock.monotonic())
+                    if not on_time:
+                        continue
+                    commanded[index + 1] = self._command_servo(angles[index + 1], steps[index + 1].dwell)
+            
+            reading = self._wait_reading()
+            if reading is None:
+                if self.control.interrupted():
+                    continue
+                if not self.acquisition.is_running:
+                    raise RuntimeError("TOF acquisition stopped")
+                # Timed out: give this angle up like a failed read
+                self.timeline.count('missed')
+                commanded.pop(index, None)
+                index += 1
+                continue
+            
+            processing = self.clock.monotonic()
+            angle = angles[index]
+            left = commanded.get(index + 1)
+            if left is not None:
+                left += SERVO_COMMAND_LATENCY
             
-            self._scan_at_angle(angle)
+            if reading.integration_start >= settled and (left is None or reading.integration_end <= left):
+                self._current_servo_angle = angle
+                if reading.distance is not None and reading.distance > 0:
+                    self._add_reading(angle, reading.distance)
+                if angle % 10 == 0:
+                    self._notify_progress()
+                del commanded[index]
+                index += 1
+            elif left is not None and reading.integration_end > left:
+                # The servo moved on before this angle was read
+                self.timeline.count('missed')
+                del commanded[index]
+                index += 1
+            else:
+                # Integrated while the servo was still settling
+                self.timeline.count('discarded')
+            
+            self.timeline.record('processing', processing, self.clock.monotonic())
+    
+    def _sweep_velocity(self, spacing: float) -> float:
+        """
+        Get the servo velocity for continuous sweeps.
+        
+        Args:
+            spacing: Servo angle between scheduled readings in degrees
+        
+        Returns:
+            SCAN_SWEEP_VELOCITY, or one reading spacing per measured ranging
+            period so the readings keep the spacing of the stepped sweep
+        """
+        if SCAN_SWEEP_VELOCITY:
+            return SCAN_SWEEP_VELOCITY
+        return spacing / self.tof.measurement_period
+    
+    def _scan_continuous(self, steps: List[MotionStep]):
+        """
+        Sweep the servo at constant velocity while the sensor ranges back to back.
+        
+        There is no settle time per angle: each reading is stamped with the
+        clock time at the middle of its integration and assigned the
+        servo angle interpolated at that time.
+        
+        Args:
+            steps: Steps at one stepper angle; the servo has settled at the first
+        """
+        start, end = steps[0].servo, steps[-1].servo
+        spacing = abs(end - start) / (len(steps) - 1) if len(steps) > 1 else 1.0
+        
+        velocity = self._sweep_velocity(spacing)
+        started = self.servo.start_sweep(start, end, velocity)
+        self.motion.sweep(started)
+        last_progress = float(start)
+        self._drain_readings()
         
-        # Pause at start
-        time.sleep(SCAN_DELAY_AT_ENDS)
+        try:
+            while self.servo.is_sweeping and not self.control.stopped:
+                if self.control.paused:
+                    # Hold the servo where it is and carry on from there
+                    angle = self.servo.stop_sweep()
+                    if not self._hold_while_paused():
+                        return
+                    started = self.servo.start_sweep(angle, end, velocity)
+                    self.motion.sweep(started)
+                
+                reading = self._wait_reading()
+                if reading is None:
+                    continue
+                
+                processing = self.clock.monotonic()
+                if reading.mid < started:
+                    # Integration began before the sweep, possibly while moving
+                    self.timeline.count('discarded')
+                    continue
+                
+                servo_angle = round(self.servo.angle_at(reading.mid), 2)
+                self._current_servo_angle = servo_angle
+                
+                if reading.distance is not None and reading.distance > 0:
+                    self._add_reading(servo_angle, reading.distance)
+                
+                # Notify progress periodically
+                if abs(servo_angle - last_progress) >= 10:
+                    last_progress = servo_angle
+                    self._notify_progress()
+                
+                self.timeline.record('processing', processing, self.clock.monotonic())
+        finally:
+            stopped = self.clock.monotonic()
+            self.motion.add(stopped, stopped, self.servo.stop_sweep())
     
-    def _scan_at_angle(self, servo_angle: int):
+    def _scan_at_angle(self, servo_angle: float, settle: float = SERVO_SETTLE_TIME):
         """
         Take a TOF reading at the specified servo angle.
         
         Args:
             servo_angle: Servo angle in degrees
+            settle: Time to let the servo settle before reading (seconds)
         """
         # Move servo
+        commanded = self.clock.monotonic()
+        self.motion.add(commanded + SERVO_COMMAND_LATENCY, commanded + settle, servo_angle)
         self.servo.move_to(servo_angle, smooth=False)
         self._current_servo_angle = servo_angle
         
-        # Wait for servo to settle
-        time.sleep(SERVO_SETTLE_TIME)
-        
-        # Read TOF sensor
-        distance = self.tof.read_distance()
+        if self.acquisition.is_running:
+            # Ranging in the background with the other sensors: take the
+            # first integration after the servo settled
+            settled = commanded + settle
+            while True:
+                distance = self._read_at_rest(settled)
+                if not self.control.interrupted():
+                    break
+                if not self._hold_while_paused():
+                    return
+                settled = self.clock.monotonic()
+        else:
+            # Wait for servo to settle
+            if not self._wait_until(self.clock.monotonic() + settle):
+                return
+            
+            if self.sub_field_scan:
+                self._read_sub_fields(servo_angle)
+                distance = None
+            else:
+                # Read TOF sensor
+                distance = self.tof.read_distance()
         
         if distance is not None and distance > 0:
-            # Add point to cloud
-            point = self.point_cloud.add_point_spherical(
-                theta=servo_angle,
-                phi=self._current_stepper_angle,
-                distance=distance
-            )
-            
-            if point:
-                self._add_to_batch(point)
+            self._add_reading(servo_angle, distance)
         
         # Notify progress periodically
         if servo_angle % 10 == 0:
             self._notify_progress()
     
-    def _add_to_batch(self, point: Point3D):
-        """Add point to batch and send if batch is ready."""
-        self._point_batch.append(point)
+    def _read_sub_fields(self, servo_angle: float) -> bool:
+        """
+        Range every region of interest of the sub-field grid at the current pose.
         
-        current_time = time.time()
+        Each reading is added at the direction its ROI steers the beam to.
+        A pause holds between ROIs.
+        
+        Args:
+            servo_angle: Servo angle of the pose in degrees
+        
+        Returns:
+            True once every ROI was ranged, False if a stop was requested
+        """
+        stepper_angle = self._current_stepper_angle
+        for field in self.sub_fields:
+            if not self._hold_while_paused():
+                return False
+            self.tof.set_sub_field(field)
+            distance = self.tof.read_distance()
+            if distance is not None and distance > 0:
+                theta, phi = steer_angles(servo_angle, stepper_angle, field.along, field.across)
+                self._add_reading(round(theta, 2), distance, round(phi, 2))
+        return True
+    
+    def _add_reading(self, servo_angle: float, distance: int,
+                     stepper_angle: Optional[float] = None):
+        """
+        Queue a reading and add the batch to the cloud when it is ready.
+        
+        Keeps per-reading work in the scan thread to three list appends;
+        the conversion, locking and notification happen once per batch.
+        
+        Args:
+            servo_angle: Servo angle of the reading in degrees
+            distance: Distance in millimeters
+            stepper_angle: Stepper angle of the reading in degrees
+                           (default: the current one)
+        """
+        self._pending_theta.append(servo_angle)
+        self._pending_phi.append(self._current_stepper_angle if stepper_angle is None else stepper_angle)
+        self._pending_distance.append(distance)
+        
+        current_time = self.clock.monotonic()
         batch_ready = (
-            len(self._point_batch) >= WEBSOCKET_BATCH_SIZE or
+            len(self._pending_theta) >= WEBSOCKET_BATCH_SIZE or
             current_time - self._last_batch_time >= WEBSOCKET_BATCH_INTERVAL
         )
         
-        if batch_ready and self._point_batch:
+        if batch_ready:
             self._flush_point_batch()
     
     def _flush_point_batch(self):
-        """Send the current batch of points to listeners."""
-        if not self._point_batch:
+        """Add queued readings to the cloud and send them to listeners."""
+        while self._extra_readings:
+            theta, phi, distance = self._extra_readings.popleft()
+            self._pending_theta.append(theta)
+            self._pending_phi.append(phi)
+            self._pending_distance.append(distance)
+        if not self._pending_theta:
+            return
+        
+        batch = self.point_cloud.add_batch(
+            self._pending_theta, self._pending_phi, self._pending_distance)
+        self._journal_call('append_points',
+                           self._pending_theta, self._pending_phi, self._pending_distance)
+        self._pending_theta = []
+        self._pending_phi = []
+        self._pending_distance = []
+        self._last_batch_time = self.clock.monotonic()
+        
+        if batch is None:
             return
-            
-        batch = self._point_batch.copy()
-        self._point_batch.clear()
-        self._last_batch_time = time.time()
         
         for callback in self._on_points:
             try:
@@ -371,15 +1292,50 @@ class ScanCoordinator:
     
     def get_progress(self) -> ScanProgress:
         """Get current scan progress."""
+        stats = self.point_cloud.get_stats()
         return ScanProgress(
             state=self._state,
             servo_angle=self._current_servo_angle,
             stepper_angle=self._current_stepper_angle,
-            points_collected=self.point_cloud.get_point_count(),
+            points_collected=stats.count,
             current_cycle=self._current_cycle,
-            total_cycles=self._total_cycles
+            total_cycles=self._total_cycles,
+            stats=stats,
+            theta_resolution=self._theta_coverage.resolution,
+            phi_resolution=self._phi_coverage.resolution,
+            resumable=self._state == ScanState.IDLE and self.resumable
         )
     
+    def get_timeline(self, recent: bool = False) -> dict:
+        """
+        Get the per-stage acquisition timeline of the current scan.
+        
+        Args:
+            recent: If True, include the latest stage intervals
+        """
+        return self.timeline.to_dict(recent=recent)
+    
+    def get_control_latency(self) -> dict:
+        """
+        Get the latency of pause/resume/stop commands.
+        
+        Returns:
+            Per command: count, p50_ms, p99_ms and max_ms from the request
+            to the scan thread acting on it
+        """
+        return self.control.latency()
+    
+    def get_replay(self) -> Optional[dict]:
+        """
+        Get the progress of a replayed session.
+        
+        Returns:
+            Recorded, replayed and diverged rangings, or None if not replaying
+        """
+        if self.replay is None:
+            return None
+        return self.tof.to_dict()
+    
     def get_state(self) -> ScanState:
         """Get current scanner state."""
         return self._state
@@ -388,7 +1344,7 @@ class ScanCoordinator:
         """Register callback for progress updates."""
         self._on_progress.append(callback)
     
-    def on_points(self, callback: Callable[[List[Point3D]], None]):
+    def on_points(self, callback: Callable[[PointBatch], None]):
         """Register callback for new points."""
         self._on_points.append(callback)
     
@@ -405,10 +1361,13 @@ class ScanCoordinator:
             self._scan_thread.join(timeout=5.0)
         
         # Close hardware
-        self.tof.close()
+        self.sensors.close()
         self.servo.close()
         self.stepper.close()
         
+        # Delete spill files
+        self.point_cloud.close()
+        
         logger.info("Scanner coordinator closed")
     
     def __enter__(self):
@@ -0,0 +1,236 @@
+"""
+Precomputed beam direction lookup table for spherical to Cartesian conversion.
+
+The set of servo/stepper angles visited by a scan is fixed, so the unit
+direction (and origin) of the beam at every angle pair is computed once and
+conversions become a multiply-add instead of four trig calls per reading.
+"""
+
+import logging
+from dataclasses import dataclass
+from typing import Optional, Tuple
+import numpy as np
+
+from ..config import (
+    SCAN_SERVO_START,
+    SCAN_SERVO_END,
+    SCAN_STEPPER_TOTAL,
+    STEPPER_DEGREES_PER_INCREMENT
+)
+
+logger = logging.getLogger(__name__)
+
+# Angles closer than this to a grid angle use the table entry (degrees)
+GRID_TOLERANCE = 1e-6
+
+
+@dataclass
+class KinematicModel:
+    """
+    Mapping from commanded servo/stepper angles to the measured ray.
+    
+    The defaults describe the ideal sphere used by
+    PointCloud.spherical_to_cartesian. Calibrated values account for
+    mounting errors of a real scanner head.
+    """
+    theta_offset: float = 0.0       # Servo zero error in degrees
+    theta_scale: float = 1.0        # Servo gain (actual degrees per commanded degree)
+    phi_offset: float = 0.0         # Stepper zero error in degrees
+    sensor_offset_mm: float = 0.0   # Sensor optical centre distance from servo axis
+    axis_height_mm: float = 0.0     # Servo axis height above the stepper origin
+    
+    def rays(self, theta_deg: np.ndarray,
+             phi_deg: np.ndarray) -> Tuple[np.ndarray, np.ndarray]:
+        """
+        Compute ray origins and unit directions for commanded angles.
+        
+        Args:
+            theta_deg: Servo angles in degrees (broadcastable with phi_deg)
+            phi_deg: Stepper angles in degrees
+        
+        Returns:
+            Tuple of (origins, directions), each of shape (..., 3)
+        """
+        theta = np.radians(np.asarray(theta_deg, dtype=np.float64) * self.theta_scale
+                           + self.theta_offset)
+        phi = np.radians(np.asarray(phi_deg, dtype=np.float64) + self.phi_offset)
+        sin_theta = np.sin(theta)
+        directions = np.stack(np.broadcast_arrays(
+            sin_theta * np.cos(phi),
+            sin_theta * np.sin(phi),
+            np.cos(theta)
+        ), axis=-1)
+        origins = directions * self.sensor_offset_mm
+        origins[..., 2] += self.axis_height_mm
+        return origins, directions
+    
+    @property
+    def is_ideal(self) -> bool:
+        """Check if the model is the ideal sphere (rays start at the origin)."""
+        return self.sensor_offset_mm == 0.0 and self.axis_height_mm == 0.0
+    
+    def to_dict(self) -> dict:
+        """Convert to dictionary for JSON serialization."""
+        return {
+            'theta_offset': self.theta_offset,
+            'theta_scale': self.theta_scale,
+            'phi_offset': self.phi_offset,
+            'sensor_offset_mm': self.sensor_offset_mm,
+            'axis_height_mm': self.axis_height_mm
+        }
+
+
+class DirectionTable:
+    """
+    Lookup table of ray directions for every (theta, phi) of a scan plan.
+    
+    Rows are servo angles, columns are stepper angles, matching RangeImage.
+    Angles that are not on the grid fall back to evaluating the model.
+    """
+    
+    def __init__(self,
+                 theta_start: float = SCAN_SERVO_START,
+                 theta_end: float = SCAN_SERVO_END,
+                 theta_step: float = 1.0,
+                 phi_total: float = SCAN_STEPPER_TOTAL,
+                 phi_step: float = STEPPER_DEGREES_PER_INCREMENT,
+                 model: Optional[KinematicModel] = None):
+        """
+        Build the table.
+        
+        Args:
+            theta_start: Servo angle of the first row in degrees
+            theta_end: Servo angle of the last row in degrees
+            theta_step: Servo angle between rows in degrees
+            phi_total: Stepper angle covered by all columns in degrees
+            phi_step: Stepper angle between columns in degrees
+            model: Kinematic model (default: ideal sphere)
+        """
+        self.theta_start = theta_start
+        self.theta_step = theta_step
+        self.phi_step = phi_step
+        self.rows = int(round((theta_end - theta_start) / theta_step)) + 1
+        self.cols = int(round(phi_total / phi_step))
+        self.model = model or KinematicModel()
+        
+        theta = theta_start + np.arange(self.rows) * theta_step
+        phi = np.arange(self.cols) * phi_step
+        origins, directions = self.model.rays(theta[:, None], phi[None, :])
+        self._origins = origins.astype(np.float32)
+        self._directions = directions.astype(np.float32)
+        self._ideal = self.model.is_ideal
+        
+        logger.debug(f"Direction table built: {self.rows}x{self.cols}")
+    
+    @property
+    def shape(self) -> Tuple[int, int]:
+        """Get (rows, cols) of the table."""
+        return (self.rows, self.cols)
+    
+    def get_directions(self) -> np.ndarray:
+        """Get a read-only view of the directions (rows x cols x 3)."""
+        view = self._directions.view()
+        view.flags.writeable = False
+        return view
+    
+    def get_origins(self) -> np.ndarray:
+        """Get a read-only view of the ray origins (rows x cols x 3)."""
+        view = self._origins.view()
+        view.flags.writeable = False
+        return view
+    
+    def cell_index(self, theta: float, phi: float) -> Optional[Tuple[int, int]]:
+        """
+        Map a single angle pair to its table cell.
+        
+        Args:
+            theta: Servo angle in degrees
+            phi: Stepper angle in degrees
+            
+        Returns:
+            (row, col) tuple, or None if the angles are not on the grid
+        """
+        row_pos = (theta - self.theta_start) / self.theta_step
+        row = int(round(row_pos))
+        if row < 0 or row >= self.rows or abs(row_pos - row) * self.theta_step >= GRID_TOLERANCE:
+            return None
+        col_pos = phi / self.phi_step
+        col = int(round(col_pos))
+        if abs(col_pos - col) * self.phi_step >= GRID_TOLERANCE:
+            return None
+        return (row, col % self.cols)
+    
+    def _row_index(self, theta):
+        """Map servo angles to row indices; -1 where off the grid."""
+        pos = (np.asarray(theta, dtype=np.float64) - self.theta_start) / self.theta_step
+        row = np.rint(pos).astype(np.int64)
+        on_grid = (np.abs(pos - row) * self.theta_step < GRID_TOLERANCE) & \
+                  (row >= 0) & (row < self.rows)
+        return np.where(on_grid, row, -1)
+    
+    def _col_index(self, phi):
+        """Map stepper angles to column indices; -1 where off the grid."""
+        pos = np.asarray(phi, dtype=np.float64) / self.phi_step
+        col = np.rint(pos).astype(np.int64)
+        on_grid = np.abs(pos - col) * self.phi_step < GRID_TOLERANCE
+        return np.where(on_grid, col % self.cols, -1)
+    
+    def to_cartesian(self, theta: float, phi: float,
+                     distance: float) -> Tuple[float, float, float]:
+        """
+        Convert a single reading to Cartesian coordinates.
+        
+        Args:
+            theta: Servo angle in degrees
+            phi: Stepper angle in degrees
+            distance: Distance in millimeters
+        
+        Returns:
+            Tuple of (x, y, z) in millimeters
+        """
+        cell = self.cell_index(theta, phi)
+        if cell is None:
+            origin, direction = self.model.rays(theta, phi)
+        else:
+            origin, direction = self._origins[cell], self._directions[cell]
+        
+        if self._ideal:
+            return tuple((direction * distance).tolist())
+        return tuple((origin + direction * distance).tolist())
+    
+    def convert(self, theta: np.ndarray, phi: np.ndarray,
+                distance: np.ndarray) -> np.ndarray:
+        """
+        Convert many readings at once.
+        
+        A whole servo sweep at one stepper angle is a single gather plus a
+        fused multiply-add over the table.
+        
+        Args:
+            theta: Servo angles in degrees (N,)
+            phi: Stepper angles in degrees (N,) or scalar
+            distance: Distances in millimeters (N,)
+        
+        Returns:
+            Float32 array of shape (N, 3)
+        """
+        theta = np.asarray(theta, dtype=np.float64)
+        phi = np.broadcast_to(np.asarray(phi, dtype=np.float64), theta.shape)
+        distance = np.asarray(distance, dtype=np.float32)
+        
+        rows = self._row_index(theta)
+        cols = self._col_index(phi)
+        hit = (rows >= 0) & (cols >= 0)
+        
+        directions = np.empty(theta.shape + (3,), dtype=np.float32)
+        origins = np.empty(theta.shape + (3,), dtype=np.float32)
+        directions[hit] = self._directions[rows[hit], cols[hit]]
+        origins[hit] = self._origins[rows[hit], cols[hit]]
+        if not hit.all():
+            miss = ~hit
+            origins[miss], directions[miss] = self.model.rays(theta[miss], phi[miss])
+        
+        points = directions * distance[..., None]
+        if not self._ideal:
+            points += origins
+        return points
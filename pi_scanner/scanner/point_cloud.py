@@ -1,16 +1,51 @@
 """
 Thread-safe point cloud buffer with spherical to Cartesian conversion.
+
+Points are stored column-wise (structure of arrays) in fixed-size numpy
+chunks, in the compact encoding of point_encoding: raw distance and
+quantized servo/stepper angle indices. Cartesian coordinates are expanded
+from it when read. Slots are written once and never reused, so the scan thread is the
+only one that takes a lock: after each write it publishes an immutable
+CloudSnapshot, and readers slice the chunks listed in the latest snapshot
+without blocking it. Once max_points is reached the oldest chunk is dropped
+in constant time, or, with spilling enabled, kept only in memory-mapped
+files on disk.
 """
 
 import logging
 import math
 import threading
+from collections import deque
 from dataclasses import dataclass
-from typing import List, Tuple, Optional, Callable
+from typing import Any, Dict, Hashable, Iterator, List, Tuple, Optional, Callable
 import numpy as np
 
+from .range_image import RangeImage
+from .direction_table import DirectionTable, KinematicModel
+from .spill_store import SpillStore
+from .point_encoding import (
+    ANGLE_SCALE,
+    QUALITY_UNKNOWN,
+    encode_servo_angles,
+    encode_stepper_angles,
+    encode_distances,
+    decode_angles
+)
+
 logger = logging.getLogger(__name__)
 
+# Points per column chunk (smaller for clouds with a small max_points)
+CHUNK_SIZE = 4096
+
+# Columns of get_columns() and iter_columns()
+POINT_COLUMNS = ('xyz', 'theta', 'phi', 'distance', 'quality')
+
+# Model used to expand points stored without a direction table
+_IDEAL_MODEL = KinematicModel()
+
+# Per-chunk statistics: (count, min, max, sum, sum of squares)
+_EMPTY_SUMMARY = (0, (math.inf,) * 3, (-math.inf,) * 3, (0.0,) * 3, (0.0,) * 3)
+
 
 @dataclass
 class Point3D:
@@ -22,6 +57,7 @@ class Point3D:
     theta: float = 0.0  # Servo angle (elevation)
     phi: float = 0.0    # Stepper angle (azimuth)
     distance: float = 0.0  # Original distance in mm
+    seq: int = -1  # Sequence number in the owning PointCloud
     
     def to_tuple(self) -> Tuple[float, float, float]:
         """Return point as (x, y, z) tuple."""
@@ -32,29 +68,567 @@ class Point3D:
         return [self.x, self.y, self.z]
 
 
+@dataclass
+class CloudStats:
+    """Per-axis statistics of the points currently in the cloud."""
+    count: int
+    min: Tuple[float, float, float]
+    max: Tuple[float, float, float]
+    mean: Tuple[float, float, float]
+    std: Tuple[float, float, float]
+    
+    def to_dict(self) -> dict:
+        """Convert to dictionary for JSON serialization."""
+        return {
+            'count': self.count,
+            'min': list(self.min),
+            'max': list(self.max),
+            'mean': list(self.mean),
+            'std': list(self.std)
+        }
+
+
+def _build_points(xyz: np.ndarray, theta: np.ndarray, phi: np.ndarray,
+                  distance: np.ndarray, start_seq: int) -> List[Point3D]:
+    """Build Point3D objects from point columns."""
+    return [
+        Point3D(x=x, y=y, z=z, theta=t, phi=p, distance=d, seq=start_seq + i)
+        for i, ((x, y, z), t, p, d) in enumerate(zip(
+            xyz.tolist(), theta.tolist(), phi.tolist(), distance.tolist()))
+    ]
+
+
+@dataclass
+class PointBatch:
+    """
+    A batch of points added in one call, stored column-wise.
+    
+    Sequence numbers are contiguous: start_seq .. start_seq + len - 1.
+    """
+    xyz: np.ndarray        # (N, 3) float32 Cartesian coordinates in mm
+    theta: np.ndarray      # (N,) servo angles in degrees
+    phi: np.ndarray        # (N,) stepper angles in degrees
+    distance: np.ndarray   # (N,) uint16 distances in mm
+    servo_index: np.ndarray    # (N,) uint16 encoded servo angles
+    stepper_index: np.ndarray  # (N,) uint16 encoded stepper angles
+    quality: np.ndarray        # (N,) uint8 sample quality
+    start_seq: int
+    table: Optional[DirectionTable] = None  # Table the points were converted with
+    
+    def __len__(self) -> int:
+        """Return number of points in the batch."""
+        return len(self.xyz)
+    
+    @property
+    def end_seq(self) -> int:
+        """Sequence number following the last point of the batch."""
+        return self.start_seq + len(self.xyz)
+    
+    def to_points(self) -> List[Point3D]:
+        """Build Point3D objects for the batch."""
+        return _build_points(self.xyz, self.theta, self.phi, self.distance, self.start_seq)
+    
+    def encoded(self) -> Dict[str, np.ndarray]:
+        """Get the encoded columns of the batch."""
+        return {
+            'distance': self.distance,
+            'servo_index': self.servo_index,
+            'stepper_index': self.stepper_index,
+            'quality': self.quality
+        }
+    
+    @property
+    def model(self) -> KinematicModel:
+        """Kinematic model that expands the encoded points to xyz."""
+        return self.table.model if self.table is not None else _IDEAL_MODEL
+
+
+def _to_cartesian(table: Optional[DirectionTable], theta: np.ndarray,
+                  phi: np.ndarray, distance: np.ndarray) -> np.ndarray:
+    """
+    Expand readings to Cartesian coordinates.
+    
+    Args:
+        table: Direction table, or None for the ideal sphere
+        theta: Servo angles in degrees (N,)
+        phi: Stepper angles in degrees (N,)
+        distance: Distances in millimeters (N,)
+        
+    Returns:
+        Float32 array of shape (N, 3)
+    """
+    if table is not None:
+        xyz = table.convert(theta, phi, distance)
+    else:
+        xyz = PointCloud.spherical_to_cartesian_array(
+            theta, phi, np.asarray(distance, dtype=np.float64))
+    return xyz.astype(np.float32, copy=False)
+
+
+def _summarize(xyz: np.ndarray) -> tuple:
+    """Compute a chunk summary of stored float32 coordinates."""
+    values = xyz.astype(np.float64)
+    return (
+        len(values),
+        tuple(values.min(axis=0).tolist()),
+        tuple(values.max(axis=0).tolist()),
+        tuple(values.sum(axis=0).tolist()),
+        tuple((values * values).sum(axis=0).tolist())
+    )
+
+
+def _merge_summaries(a: tuple, b: tuple) -> tuple:
+    """Combine two chunk summaries."""
+    return (
+        a[0] + b[0],
+        tuple(map(min, a[1], b[1])),
+        tuple(map(max, a[2], b[2])),
+        tuple(x + y for x, y in zip(a[3], b[3])),
+        tuple(x + y for x, y in zip(a[4], b[4]))
+    )
+
+
+class _Chunk:
+    """
+    Fixed-size block of encoded point columns (7 bytes per point).
+    
+    Only the writer touches slots at or above `filled`; slots below it are
+    never modified again, so readers may slice them without a lock. The
+    summary of the expanded coordinates is replaced (not mutated) on every
+    write so it is always consistent with some value of `filled`.
+    """
+    __slots__ = ('start_seq', 'distance', 'servo_index', 'stepper_index', 'quality',
+                 'filled', 'summary')
+    
+    def __init__(self, start_seq: int, size: int):
+        self.start_seq = start_seq
+        self.distance = np.empty(size, dtype=np.uint16)
+        self.servo_index = np.empty(size, dtype=np.uint16)
+        self.stepper_index = np.empty(size, dtype=np.uint16)
+        self.quality = np.empty(size, dtype=np.uint8)
+        self.filled = 0
+        self.summary = _EMPTY_SUMMARY
+    
+    @property
+    def free(self) -> int:
+        """Number of slots not yet written."""
+        return len(self.distance) - self.filled
+    
+    def write_one(self, xyz: Tuple[float, float, float], distance: int,
+                  servo_index: int, stepper_index: int, quality: int):
+        """Store one point in the next free slot (writer only)."""
+        i = self.filled
+        self.distance[i] = distance
+        self.servo_index[i] = servo_index
+        self.stepper_index[i] = stepper_index
+        self.quality[i] = quality
+        
+        # Track the float32 values readers will expand to
+        values = np.asarray(xyz, dtype=np.float32).tolist()
+        n, lo, hi, total, sq = self.summary
+        self.summary = (
+            n + 1,
+            tuple(map(min, lo, values)),
+            tuple(map(max, hi, values)),
+            tuple(t + v for t, v in zip(total, values)),
+            tuple(s + v * v for s, v in zip(sq, values))
+        )
+        self.filled = i + 1
+    
+    def write(self, xyz: np.ndarray, columns: Dict[str, np.ndarray]) -> int:
+        """
+        Store as many points as fit in the free slots (writer only).
+        
+        Args:
+            xyz: Expanded float32 coordinates, for the summary only
+            columns: Encoded columns keyed by name
+        
+        Returns:
+            Number of points stored
+        """
+        start = self.filled
+        n = min(len(xyz), self.free)
+        slots = slice(start, start + n)
+        for name, column in columns.items():
+            getattr(self, name)[slots] = column[:n]
+        self.summary = _merge_summaries(self.summary, _summarize(xyz[:n]))
+        self.filled = start + n
+        return n
+
+
+class CloudSnapshot:
+    """
+    Immutable, versioned view of the point cloud.
+    
+    Holds references to the chunks that were live when it was taken, so
+    its points stay readable (and unchanged) even after the cloud evicts
+    or clears them. Consecutive versions share every sealed chunk; only
+    the newest, still-filling chunk differs. Taking a snapshot is a single
+    attribute read.
+    
+    Stats and anything else derived from a snapshot (export files,
+    encoded payloads) are computed once and cached on it, so concurrent
+    readers of the same version share one result. Expanded point columns
+    are not cached: iter_columns() decodes them a slice at a time, so bulk
+    readers never hold a full float32 copy of a spilled cloud.
+    """
+    
+    def __init__(self, chunks: Tuple[_Chunk, ...], base_seq: int,
+                 next_seq: int, version: int = 0,
+                 spill: Optional[SpillStore] = None,
+                 cold_summary: tuple = _EMPTY_SUMMARY,
+                 frames: Tuple[Tuple[int, Optional[DirectionTable]], ...] = ((0, None),)):
+        """
+        Initialize the snapshot.
+        
+        Args:
+            chunks: Live chunks, oldest first
+            base_seq: Sequence number at the last clear()
+            next_seq: Sequence number of the next point to be added
+            version: Publish counter of the owning cloud
+            spill: Spill files holding every point since the last clear
+            cold_summary: Summary of the points only held in the spill files
+            frames: (first sequence number, direction table) of each run of
+                    points converted with the same table, oldest first
+        """
+        self._chunks = chunks
+        self._frames = frames
+        self.base_seq = base_seq
+        self.next_seq = next_seq
+        self.version = version
+        self._spill = spill
+        self._cold_summary = cold_summary
+        self._hot_first = chunks[0].start_seq if chunks else next_seq
+        self.first_seq = spill.start_seq if spill is not None else self._hot_first
+        # The newest chunk may still be filling; pin its summary now
+        self._tail_summary = chunks[-1].summary if chunks else _EMPTY_SUMMARY
+        self._cache: Dict[Hashable, Any] = {}
+    
+    def cached(self, key: Hashable, build: Callable[['CloudSnapshot'], Any]) -> Any:
+        """
+        Get a result derived from this snapshot, building it on first use.
+        
+        Concurrent first calls may both build; the first result stored is
+        returned to everyone. A None result is not cached.
+        
+        Args:
+            key: Cache key naming the derived result
+            build: Function computing the result from the snapshot
+            
+        Returns:
+            The cached or newly built result
+        """
+        try:
+            return self._cache[key]
+        except KeyError:
+            pass
+        value = build(self)
+        if value is None:
+            return None
+        return self._cache.setdefault(key, value)
+    
+    def discard(self, key: Hashable):
+        """
+        Drop a cached derived result (e.g. an export file that was deleted).
+        
+        Args:
+            key: Cache key passed to cached()
+        """
+        self._cache.pop(key, None)
+    
+    def __len__(self) -> int:
+        """Return number of points in the snapshot."""
+        return self.next_seq - self.first_seq
+    
+    def _gather(self, name: str, start: int, end: int) -> np.ndarray:
+        """
+        Get a read-only encoded column for sequence numbers [start, end).
+        
+        Ranges inside one chunk are returned as views; ranges spanning
+        chunks are concatenated. Points older than the in-memory chunks are
+        mapped from the spill files, which hold at least those.
+        """
+        parts = []
+        if self._spill is not None and start < self._hot_first:
+            parts.append(self._spill.view(name, start, min(end, self._hot_first)))
+        
+        for chunk in self._chunks:
+            lo = max(start, chunk.start_seq) - chunk.start_seq
+            hi = min(end, chunk.start_seq + len(chunk.distance)) - chunk.start_seq
+            if hi > lo:
+                parts.append(getattr(chunk, name)[lo:hi])
+        
+        if len(parts) == 1:
+            column = parts[0].view()
+        elif parts:
+            column = np.concatenate(parts)
+        else:
+            column = getattr(_EMPTY_CHUNK, name).view()
+        column.flags.writeable = False
+        return column
+    
+    def snapshot(self) -> 'CloudSnapshot':
+        """Return the snapshot itself, so snapshots can stand in for a PointCloud."""
+        return self
+    
+    def _expand_xyz(self, start: int, end: int) -> np.ndarray:
+        """Expand the points [start, end) to Cartesian, frame by frame."""
+        distance = self._gather('distance', start, end)
+        theta = decode_angles(self._gather('servo_index', start, end))
+        phi = decode_angles(self._gather('stepper_index', start, end))
+        
+        xyz = np.empty((len(distance), 3), dtype=np.float32)
+        for i, (frame_start, table) in enumerate(self._frames):
+            frame_end = self._frames[i + 1][0] if i + 1 < len(self._frames) else end
+            lo = max(start, frame_start) - start
+            hi = min(end, frame_end) - start
+            if hi > lo:
+                xyz[lo:hi] = _to_cartesian(table, theta[lo:hi], phi[lo:hi], distance[lo:hi])
+        return xyz
+    
+    def _expand(self, name: str, start: int, end: int) -> np.ndarray:
+        """
+        Get a read-only column for [start, end), expanding derived columns.
+        
+        'xyz', 'theta' and 'phi' are computed from the encoded columns;
+        any other name is an encoded column.
+        """
+        if name == 'xyz':
+            column = self._expand_xyz(start, end)
+        elif name == 'theta':
+            column = decode_angles(self._gather('servo_index', start, end)).astype(np.float32)
+        elif name == 'phi':
+            column = decode_angles(self._gather('stepper_index', start, end)).astype(np.float32)
+        else:
+            return self._gather(name, start, end)
+        column.flags.writeable = False
+        return column
+    
+    def iter_columns(self, names: Tuple[str, ...] = POINT_COLUMNS,
+                     start: Optional[int] = None,
+                     size: int = CHUNK_SIZE) -> Iterator[Dict[str, np.ndarray]]:
+        """
+        Read point columns in slices, oldest first.
+        
+        Only the slice being read is expanded, so memory use is bounded by
+        the slice size however many points the snapshot holds.
+        
+        Args:
+            names: Columns wanted (see get_columns(); encoded column names
+                   work too)
+            start: First sequence number wanted (default: oldest held)
+            size: Maximum points per slice
+            
+        Yields:
+            Dictionary of read-only arrays keyed by column name, one slice
+            of consecutive points each
+        """
+        start = self.first_seq if start is None else max(start, self.first_seq)
+        for lo in range(start, self.next_seq, size):
+            hi = min(lo + size, self.next_seq)
+            yield {name: self._expand(name, lo, hi) for name in names}
+    
+    def get_point_count(self) -> int:
+        """Return number of points in the snapshot."""
+        return len(self)
+    
+    def get_points_as_numpy(self, start: Optional[int] = None) -> np.ndarray:
+        """
+        Get points as a read-only float32 array (N x 3), expanded on every call.
+        
+        Args:
+            start: First sequence number wanted (default: oldest held)
+        """
+        start = self.first_seq if start is None else max(start, self.first_seq)
+        return self._expand('xyz', start, self.next_seq)
+    
+    def get_columns(self) -> Dict[str, np.ndarray]:
+        """
+        Get read-only arrays of all point columns, expanded on every call.
+        
+        Prefer iter_columns() for reading a large cloud.
+        
+        Returns:
+            Dictionary with 'xyz' (N x 3 float32), 'theta' and 'phi'
+            (float32 degrees), 'distance' (uint16 mm) and 'quality' (uint8)
+        """
+        return {name: self._expand(name, self.first_seq, self.next_seq)
+                for name in POINT_COLUMNS}
+    
+    def get_encoded(self, start: Optional[int] = None) -> Dict[str, np.ndarray]:
+        """
+        Get the encoded columns without expanding them.
+        
+        Args:
+            start: First sequence number wanted (default: oldest held)
+            
+        Returns:
+            Dictionary with 'distance', 'servo_index', 'stepper_index'
+            (uint16) and 'quality' (uint8)
+        """
+        start = self.first_seq if start is None else max(start, self.first_seq)
+        return {name: self._gather(name, start, self.next_seq)
+                for name in ('distance', 'servo_index', 'stepper_index', 'quality')}
+    
+    def get_frames(self, start: Optional[int] = None) -> List[Tuple[int, KinematicModel]]:
+        """
+        Get the kinematic models needed to expand encoded points.
+        
+        Args:
+            start: First sequence number of interest (default: oldest held)
+            
+        Returns:
+            List of (first sequence number, model) for each run of points
+            from start on, oldest first
+        """
+        start = self.first_seq if start is None else max(start, self.first_seq)
+        frames = []
+        for i, (frame_start, table) in enumerate(self._frames):
+            frame_end = self._frames[i + 1][0] if i + 1 < len(self._frames) else self.next_seq
+            if frame_end > start or i + 1 == len(self._frames):
+                model = table.model if table is not None else _IDEAL_MODEL
+                frames.append((max(frame_start, start), model))
+        return frames
+    
+    def resolve_cursor(self, cursor: Optional[int]) -> Tuple[int, bool]:
+        """
+        Work out where a client with the given cursor should resume.
+        
+        See PointCloud.get_points_since().
+        
+        Args:
+            cursor: Sequence number of the first point wanted, or None
+            
+        Returns:
+            Tuple of (first sequence number to send, reset flag)
+        """
+        reset = (cursor is None or cursor <= self.base_seq or
+                 cursor < self.first_seq or cursor > self.next_seq)
+        return (self.first_seq if reset else cursor, reset)
+    
+    def get_points_since(self, cursor: Optional[int]) -> Tuple[np.ndarray, int, bool]:
+        """
+        Get the points added since a sequence cursor.
+        
+        See PointCloud.get_points_since().
+        
+        Args:
+            cursor: Sequence number of the first point wanted, or None
+            
+        Returns:
+            Tuple of (points N x 3 read-only array, next cursor, reset flag)
+        """
+        start, reset = self.resolve_cursor(cursor)
+        return (self.get_points_as_numpy(start), self.next_seq, reset)
+    
+    def get_points(self, start: Optional[int] = None) -> List[Point3D]:
+        """
+        Build Point3D objects for the snapshot.
+        
+        Args:
+            start: First sequence number wanted (default: oldest held)
+        """
+        start = self.first_seq if start is None else max(start, self.first_seq)
+        end = self.next_seq
+        return _build_points(
+            self._expand('xyz', start, end), self._expand('theta', start, end),
+            self._expand('phi', start, end), self._gather('distance', start, end),
+            start)
+    
+    def get_stats(self) -> CloudStats:
+        """
+        Get per-axis statistics from the per-chunk summaries.
+        
+        Returns:
+            CloudStats with count, min, max, mean and standard deviation
+        """
+        return self.cached('stats', CloudSnapshot._compute_stats)
+    
+    def _compute_stats(self) -> CloudStats:
+        """Combine the chunk summaries into CloudStats."""
+        summary = _merge_summaries(self._cold_summary, self._tail_summary)
+        for chunk in self._chunks[:-1]:
+            summary = _merge_summaries(summary, chunk.summary)
+        
+        n, lo, hi, total, sq = summary
+        if n == 0:
+            zero = (0.0, 0.0, 0.0)
+            return CloudStats(count=0, min=zero, max=zero, mean=zero, std=zero)
+        
+        mean = tuple(s / n for s in total)
+        std = tuple(math.sqrt(max(0.0, s / n - m * m)) for s, m in zip(sq, mean))
+        return CloudStats(count=n, min=lo, max=hi, mean=mean, std=std)
+
+
+_EMPTY_CHUNK = _Chunk(0, 0)
+
+
 class PointCloud:
     """
     Thread-safe point cloud buffer for collecting 3D scan data.
     
     Handles conversion from spherical coordinates (servo angle, stepper angle, distance)
     to Cartesian coordinates (x, y, z).
+    
+    Storage layout (see point_encoding):
+    - distance: uint16 raw distance in mm
+    - servo_index, stepper_index: uint16 angles in hundredths of a degree
+    - quality: uint8 sample quality
+    
+    Angles are quantized to 0.01 degree on insert. xyz (float32) and
+    theta/phi (float32 degrees) are expanded when read, using the direction
+    table that was active when each point was added. Point3D objects are
+    only created on demand as a compatibility view.
+    
+    Every point gets a monotonically increasing sequence number. The cloud
+    always holds sequence numbers [first_seq, next_seq); when max_points
+    would be exceeded the oldest chunk of points is evicted, and anything
+    below first_seq has been dropped.
+    
+    Writers serialize on a lock. Readers never take it: every accessor
+    works on the latest published CloudSnapshot, so bulk reads cannot
+    stall acquisition.
+    
+    With a spill directory, every point is also appended to memory-mapped
+    column files, a whole chunk at a time once it is full. max_points then only bounds the hot window kept in RAM:
+    evicted chunks stay readable from disk and nothing is dropped.
     """
     
-    def __init__(self, max_points: int = 100000):
+    def __init__(self, max_points: int = 100000,
+                 range_image: Optional[RangeImage] = None,
+                 spill_directory: Optional[str] = None):
         """
         Initialize the point cloud buffer.
         
         Args:
             max_points: Maximum number of points to store (prevents memory issues)
+            range_image: Optional organized store that also receives every
+                         spherical point, indexed by (servo, stepper) angle
+            spill_directory: If set, keep all points in memory-mapped files
+                             in this directory; max_points becomes the RAM
+                             hot window
         """
-        self._points: List[Point3D] = []
-        self._lock = threading.RLock()
+        self.range_image = range_image
+        self.direction_table: Optional[DirectionTable] = None
+        self._lock = threading.Lock()  # Serializes writers only
         self._max_points = max_points
+        self._chunk_size = min(CHUNK_SIZE, max(1, max_points // 8))
+        self._chunks = deque()
+        self._next_seq = 0   # Sequence number of the next point added
+        self._base_seq = 0   # Sequence number at the last clear()
+        self._evicting = False
+        self._version = 0
+        self._spill_directory = spill_directory
+        self._spill: Optional[SpillStore] = None
+        self._cold_summary = _EMPTY_SUMMARY
+        self._frames = [(0, None)]
+        self._open_spill()
+        self._snapshot = CloudSnapshot((), 0, 0, spill=self._spill)
         self._on_point_added: List[Callable[[Point3D], None]] = []
-        self._on_batch_added: List[Callable[[List[Point3D]], None]] = []
-        
+        self._on_batch_added: List[Callable[[PointBatch], None]] = []
+    
     @staticmethod
-    def spherical_to_cartesian(theta_deg: float, phi_deg: float, 
+    def spherical_to_cartesian(theta_deg: float, phi_deg: float,
                                 distance_mm: float) -> Tuple[float, float, float]:
         """
         Convert spherical coordinates to Cartesian.
@@ -68,7 +642,7 @@ class PointCloud:
             theta_deg: Servo angle in degrees (0-180, elevation)
             phi_deg: Stepper angle in degrees (0-360, azimuth)
             distance_mm: Distance in millimeters
-            
+        
         Returns:
             Tuple of (x, y, z) in millimeters
         """
@@ -84,46 +658,202 @@ class PointCloud:
         
         return (x, y, z)
     
+    def set_direction_table(self, table: Optional[DirectionTable]):
+        """
+        Use a precomputed direction table for spherical conversions.
+        
+        The table is shared with the range image, if any.
+        
+        Args:
+            table: Direction table for the active scan plan, or None for
+                   the ideal spherical_to_cartesian conversion
+        """
+        self.direction_table = table
+        if self.range_image is not None:
+            self.range_image.direction_table = table
+    
+    def _open_spill(self):
+        """Start new spill files at the next sequence number (lock held)."""
+        self._spill = None
+        self._cold_summary = _EMPTY_SUMMARY
+        if self._spill_directory is None:
+            return
+        try:
+            self._spill = SpillStore(self._next_seq, self._spill_directory)
+        except OSError as e:
+            logger.error(f"Failed to create spill files, keeping points in RAM only: {e}")
+    
+    def _flush_spill(self):
+        """Append the points not yet spilled to the spill files, if any (lock held)."""
+        for chunk in self._chunks:
+            if self._spill is None:
+                return
+            first = max(self._spill.end_seq - chunk.start_seq, 0)
+            if first < chunk.filled:
+                self._spill_points({name: getattr(chunk, name)[first:chunk.filled]
+                                    for name in ('distance', 'servo_index', 'stepper_index', 'quality')})
+    
+    def _spill_points(self, columns: Dict[str, np.ndarray]):
+        """Append written points to the spill files, if any (lock held)."""
+        if self._spill is not None and not self._spill.append(columns):
+            # The files no longer hold every point; fall back to RAM only.
+            # Snapshots published so far only map ranges that were written.
+            logger.error("Spilling disabled, oldest points will be evicted")
+            self._spill = None
+            self._cold_summary = _EMPTY_SUMMARY
+    
+    def _writable_chunk(self) -> _Chunk:
+        """
+        Get the chunk the next point goes into (lock held).
+        
+        Starts a new chunk when the newest one is full, first evicting the
+        oldest chunks so the cloud stays within max_points.
+        """
+        if self._chunks and self._chunks[-1].free > 0:
+            return self._chunks[-1]
+        
+        # The full chunks go to disk in one write per column
+        self._flush_spill()
+        while self._chunks and \
+                self._next_seq - self._chunks[0].start_seq + self._chunk_size > self._max_points:
+            evicted = self._chunks.popleft()
+            if self._spill is not None:
+                # Still on disk: only leaves the RAM window
+                self._cold_summary = _merge_summaries(self._cold_summary, evicted.summary)
+            elif not self._evicting:
+                logger.warning(f"Point cloud at capacity ({self._max_points}), "
+                               f"evicting oldest points")
+                self._evicting = True
+        
+        # Drop the frames of points no longer held
+        oldest = self._spill.start_seq if self._spill is not None else (
+            self._chunks[0].start_seq if self._chunks else self._next_seq)
+        while len(self._frames) > 1 and self._frames[1][0] <= oldest:
+            del self._frames[0]
+        
+        chunk = _Chunk(self._next_seq, self._chunk_size)
+        self._chunks.append(chunk)
+        return chunk
+    
+    def _publish(self):
+        """Publish a snapshot of the written points to readers (lock held)."""
+        self._version += 1
+        self._snapshot = CloudSnapshot(tuple(self._chunks), self._base_seq,
+                                       self._next_seq, self._version,
+                                       self._spill, self._cold_summary,
+                                       tuple(self._frames))
+    
+    def _use_table(self, table: Optional[DirectionTable]):
+        """Start a new frame if points are now converted with another table (lock held)."""
+        frame_start, current = self._frames[-1]
+        if table is current:
+            return
+        if frame_start == self._next_seq:
+            self._frames[-1] = (frame_start, table)
+        else:
+            self._frames.append((self._next_seq, table))
+    
+    def _append(self, xyz: Tuple[float, float, float], distance: int,
+                servo_index: int, stepper_index: int,
+                table: Optional[DirectionTable]) -> int:
+        """
+        Append one encoded point (thread-safe).
+        
+        Args:
+            xyz: Expanded coordinates, for the running statistics
+            distance, servo_index, stepper_index: Encoded reading
+            table: Direction table xyz was computed with
+        
+        Returns:
+            Sequence number assigned to the point
+        """
+        with self._lock:
+            self._use_table(table)
+            self._writable_chunk().write_one(xyz, distance, servo_index,
+                                             stepper_index, QUALITY_UNKNOWN)
+            seq = self._next_seq
+            self._next_seq = seq + 1
+            self._publish()
+            return seq
+    
+    def _append_many(self, xyz: np.ndarray, columns: Dict[str, np.ndarray],
+                     table: Optional[DirectionTable]) -> int:
+        """
+        Append many encoded points under a single lock acquisition.
+        
+        Args:
+            xyz: Expanded coordinates, for the running statistics
+            columns: Encoded columns keyed by name
+            table: Direction table xyz was computed with
+        
+        Returns:
+            Sequence number assigned to the first point
+        """
+        with self._lock:
+            self._use_table(table)
+            start_seq = self._next_seq
+            done = 0
+            while done < len(xyz):
+                n = self._writable_chunk().write(
+                    xyz[done:], {name: column[done:] for name, column in columns.items()})
+                done += n
+                self._next_seq += n
+            self._publish()
+            return start_seq
+    
+    def _notify_point(self, point: Point3D):
+        """Call point-added listeners."""
+        for callback in self._on_point_added:
+            try:
+                callback(point)
+            except Exception as e:
+                logger.error(f"Error in point callback: {e}")
+    
     def add_point_spherical(self, theta: float, phi: float, distance: float) -> Optional[Point3D]:
         """
         Add a point using spherical coordinates.
         
+        Angles are quantized to 0.01 degree and the distance to 1 mm; the
+        returned point holds the stored values.
+        
         Args:
             theta: Servo angle in degrees (0-180)
             phi: Stepper angle in degrees (0-360)
             distance: Distance in millimeters
-            
+        
         Returns:
             The created Point3D object, or None if distance is invalid
         """
         if distance is None or distance <= 0:
             logger.debug(f"Invalid distance: {distance}")
             return None
-            
-        # Convert to Cartesian
-        x, y, z = self.spherical_to_cartesian(theta, phi, distance)
         
-        # Create point
+        # Encode, then convert the stored values to Cartesian
+        servo_index = int(encode_servo_angles(theta))
+        stepper_index = int(encode_stepper_angles(phi))
+        distance = int(encode_distances(distance))
+        theta = servo_index / ANGLE_SCALE
+        phi = stepper_index / ANGLE_SCALE
+        table = self.direction_table
+        if table is not None:
+            x, y, z = table.to_cartesian(theta, phi, distance)
+        else:
+            x, y, z = self.spherical_to_cartesian(theta, phi, distance)
+        
+        # Add to buffer (thread-safe)
+        seq = self._append((x, y, z), distance, servo_index, stepper_index, table)
+        if self.range_image is not None:
+            self.range_image.add(theta, phi, distance)
+        
         point = Point3D(
             x=x, y=y, z=z,
-            theta=theta, phi=phi, distance=distance
+            theta=theta, phi=phi, distance=distance,
+            seq=seq
         )
         
-        # Add to buffer (thread-safe)
-        with self._lock:
-            if len(self._points) >= self._max_points:
-                # Remove oldest points if at capacity
-                self._points = self._points[1000:]  # Remove first 1000 points
-                logger.warning(f"Point cloud at capacity, removed oldest 1000 points")
-            
-            self._points.append(point)
-        
         # Notify listeners
-        for callback in self._on_point_added:
-            try:
-                callback(point)
-            except Exception as e:
-                logger.error(f"Error in point callback: {e}")
+        if self._on_point_added:
+            self._notify_point(point)
         
         return point
     
@@ -131,48 +861,195 @@ class PointCloud:
         """
         Add a point using Cartesian coordinates directly.
         
+        The point is stored as the equivalent ideal-sphere reading, so it is
+        quantized like any other (within 1 mm and 0.01 degree).
+        
         Args:
             x, y, z: Coordinates in millimeters
-            
+        
         Returns:
-            The created Point3D object
+            The created Point3D object, holding the stored coordinates
         """
-        point = Point3D(x=x, y=y, z=z)
+        r = math.sqrt(x * x + y * y + z * z)
+        theta = math.degrees(math.acos(max(-1.0, min(1.0, z / r)))) if r > 0 else 0.0
+        phi = math.degrees(math.atan2(y, x))
         
-        with self._lock:
-            if len(self._points) >= self._max_points:
-                self._points = self._points[1000:]
-            self._points.append(point)
+        servo_index = int(encode_servo_angles(theta))
+        stepper_index = int(encode_stepper_angles(phi))
+        distance = int(encode_distances(r))
+        x, y, z = self.spherical_to_cartesian(
+            servo_index / ANGLE_SCALE, stepper_index / ANGLE_SCALE, distance)
+        seq = self._append((x, y, z), distance, servo_index, stepper_index, None)
         
-        for callback in self._on_point_added:
-            try:
-                callback(point)
-            except Exception as e:
-                logger.error(f"Error in point callback: {e}")
+        point = Point3D(x=x, y=y, z=z, seq=seq)
+        
+        if self._on_point_added:
+            self._notify_point(point)
         
         return point
     
+    @staticmethod
+    def spherical_to_cartesian_array(theta_deg: np.ndarray, phi_deg: np.ndarray,
+                                     distance_mm: np.ndarray) -> np.ndarray:
+        """
+        Vectorized spherical_to_cartesian.
+        
+        Args:
+            theta_deg: Servo angles in degrees (N,)
+            phi_deg: Stepper angles in degrees (N,)
+            distance_mm: Distances in millimeters (N,)
+        
+        Returns:
+            Array of shape (N, 3) with x, y, z in millimeters
+        """
+        theta = np.radians(theta_deg)
+        phi = np.radians(phi_deg)
+        sin_theta = np.sin(theta)
+        return np.column_stack((
+            distance_mm * sin_theta * np.cos(phi),
+            distance_mm * sin_theta * np.sin(phi),
+            distance_mm * np.cos(theta)
+        ))
+    
+    def add_batch(self, theta, phi, distance, quality=None) -> Optional[PointBatch]:
+        """
+        Add many points using spherical coordinates.
+        
+        Encodes and converts the whole batch at once, takes the lock once
+        and fires a single batch notification. Point-added listeners are
+        not called.
+        
+        Args:
+            theta: Servo angles in degrees (N,)
+            phi: Stepper angles in degrees (N,) or a single angle for all
+            distance: Distances in millimeters (N,); invalid (<= 0) are dropped
+            quality: Sample quality (0-255) per point or for all (default: unknown)
+            
+        Returns:
+            The added PointBatch, or None if no distance was valid
+        """
+        theta = np.asarray(theta, dtype=np.float64)
+        phi = np.broadcast_to(np.asarray(phi, dtype=np.float64), theta.shape)
+        distance = np.asarray(distance, dtype=np.float64)
+        quality = np.broadcast_to(np.asarray(
+            QUALITY_UNKNOWN if quality is None else quality, dtype=np.uint8), theta.shape)
+        
+        valid = distance > 0
+        if not valid.all():
+            theta, phi, distance, quality = theta[valid], phi[valid], distance[valid], quality[valid]
+        if len(distance) == 0:
+            return None
+        
+        columns = {
+            'distance': encode_distances(distance),
+            'servo_index': encode_servo_angles(theta),
+            'stepper_index': encode_stepper_angles(phi),
+            'quality': np.ascontiguousarray(quality)
+        }
+        
+        # Convert the stored (quantized) values to Cartesian
+        theta = decode_angles(columns['servo_index'])
+        phi = decode_angles(columns['stepper_index'])
+        table = self.direction_table
+        xyz = _to_cartesian(table, theta, phi, columns['distance'])
+        
+        start_seq = self._append_many(xyz, columns, table)
+        if self.range_image is not None:
+            self.range_image.add_batch(theta, phi, columns['distance'])
+        
+        batch = PointBatch(xyz=xyz, theta=theta.astype(np.float32),
+                           phi=phi.astype(np.float32), start_seq=start_seq,
+                           table=table, **columns)
+        self.notify_batch(batch)
+        return batch
+    
+    def add_sweep(self, theta, phi: float, distance, quality=None) -> Optional[PointBatch]:
+        """
+        Add a whole servo sweep taken at one stepper angle.
+        
+        Args:
+            theta: Servo angles in degrees (N,)
+            phi: Stepper angle in degrees
+            distance: Distances in millimeters (N,)
+            quality: Sample quality per point or for all (default: unknown)
+            
+        Returns:
+            The added PointBatch, or None if no distance was valid
+        """
+        return self.add_batch(theta, phi, distance, quality)
+    
+    def snapshot(self) -> CloudSnapshot:
+        """
+        Get an immutable snapshot of the cloud without blocking writers.
+        
+        Bulk readers should take one snapshot and read everything they need
+        from it, so all columns and stats describe the same set of points.
+        Every write publishes a new version; readers that see the same
+        version get the same object and share its cached results.
+        
+        Returns:
+            The latest published CloudSnapshot
+        """
+        return self._snapshot
+    
     def get_points(self) -> List[Point3D]:
         """
         Get a copy of all points.
         
+        Prefer snapshot().iter_columns() or get_columns() for bulk access;
+        this builds one Point3D object per point.
+        
         Returns:
             List of Point3D objects
         """
-        with self._lock:
-            return list(self._points)
+        return self._snapshot.get_points()
     
     def get_points_as_numpy(self) -> np.ndarray:
         """
         Get points as numpy array (N x 3).
         
+        The returned array is read-only float32 and never changes after it
+        is returned. It is expanded from the encoded columns (a
+        trigonometric conversion of every point) on every call and never
+        aliases the cloud's storage; bulk readers of a large cloud should
+        use snapshot().iter_columns() instead.
+        
         Returns:
             Numpy array of shape (N, 3) with x, y, z columns
         """
-        with self._lock:
-            if not self._points:
-                return np.array([]).reshape(0, 3)
-            return np.array([[p.x, p.y, p.z] for p in self._points])
+        return self._snapshot.get_points_as_numpy()
+    
+    def get_columns(self) -> Dict[str, np.ndarray]:
+        """
+        Get read-only arrays of all point columns, expanded on every call.
+        
+        Prefer snapshot().iter_columns() for reading a large cloud.
+        
+        Returns:
+            Dictionary with 'xyz' (N x 3 float32), 'theta' and 'phi'
+            (float32 degrees), 'distance' (uint16 mm) and 'quality' (uint8)
+        """
+        return self._snapshot.get_columns()
+    
+    def get_points_since(self, cursor: Optional[int]) -> Tuple[np.ndarray, int, bool]:
+        """
+        Get the points added since a sequence cursor.
+        
+        A client passes back the cursor returned by the previous call to
+        receive only the points it has not seen yet.
+        
+        If the cursor is None, predates the last clear(), points at evicted
+        data or is ahead of the cloud, every held point is returned and the
+        reset flag is set: the client should replace its copy rather than
+        append to it.
+        
+        Args:
+            cursor: Sequence number of the first point wanted, or None
+        
+        Returns:
+            Tuple of (points N x 3 read-only array, next cursor, reset flag)
+        """
+        return self._snapshot.get_points_since(cursor)
     
     def get_points_as_list(self) -> List[List[float]]:
         """
@@ -181,8 +1058,7 @@ class PointCloud:
         Returns:
             List of [x, y, z] lists
         """
-        with self._lock:
-            return [p.to_list() for p in self._points]
+        return self.get_points_as_numpy().tolist()
     
     def get_latest_points(self, count: int) -> List[Point3D]:
         """
@@ -190,12 +1066,14 @@ class PointCloud:
         
         Args:
             count: Number of points to retrieve
-            
+        
         Returns:
             List of most recent Point3D objects
         """
-        with self._lock:
-            return list(self._points[-count:])
+        snapshot = self._snapshot
+        if count <= 0:
+            return snapshot.get_points()
+        return snapshot.get_points(snapshot.next_seq - count)
     
     def get_point_count(self) -> int:
         """
@@ -204,15 +1082,62 @@ class PointCloud:
         Returns:
             Number of points
         """
-        with self._lock:
-            return len(self._points)
+        return len(self._snapshot)
+    
+    def get_sequence_range(self) -> Tuple[int, int]:
+        """
+        Get the range of sequence numbers currently held.
+        
+        Points with sequence numbers below first_seq have been evicted.
+        
+        Returns:
+            Tuple of (first_seq, next_seq); the cloud holds [first_seq, next_seq)
+        """
+        snapshot = self._snapshot
+        return (snapshot.first_seq, snapshot.next_seq)
+    
+    def get_dropped_count(self) -> int:
+        """
+        Get the number of points evicted since the last clear.
+        
+        Returns:
+            Number of dropped points
+        """
+        snapshot = self._snapshot
+        return snapshot.first_seq - snapshot.base_seq
     
     def clear(self):
-        """Clear all points from the buffer."""
+        """
+        Clear all points from the buffer.
+        
+        Sequence numbers keep increasing across clears. Snapshots taken
+        before the clear keep their points.
+        """
         with self._lock:
-            self._points.clear()
+            self._chunks = deque()
+            self._base_seq = self._next_seq
+            self._evicting = False
+            self._frames = [(self._next_seq, self._frames[-1][1])]
+            # Old spill files are deleted once the last snapshot using them is gone
+            self._open_spill()
+            self._publish()
+        if self.range_image is not None:
+            self.range_image.clear()
         logger.info("Point cloud cleared")
     
+    def close(self):
+        """
+        Stop spilling; the cloud keeps only its RAM window.
+        
+        The spill files are deleted once the last snapshot mapping them is
+        released (at once if there is none).
+        """
+        with self._lock:
+            if self._spill is not None:
+                self._spill = None
+                self._cold_summary = _EMPTY_SUMMARY
+                self._publish()
+    
     def on_point_added(self, callback: Callable[[Point3D], None]):
         """
         Register a callback to be called when a point is added.
@@ -222,21 +1147,21 @@ class PointCloud:
         """
         self._on_point_added.append(callback)
     
-    def on_batch_added(self, callback: Callable[[List[Point3D]], None]):
+    def on_batch_added(self, callback: Callable[[PointBatch], None]):
         """
-        Register a callback to be called when a batch of points is ready.
+        Register a callback to be called when a batch of points is added.
         
         Args:
-            callback: Function that takes a list of Point3D objects
+            callback: Function that takes a PointBatch
         """
         self._on_batch_added.append(callback)
     
-    def notify_batch(self, points: List[Point3D]):
+    def notify_batch(self, points: PointBatch):
         """
         Notify listeners about a batch of points.
         
         Args:
-            points: List of points to notify about
+            points: Batch of points to notify about
         """
         for callback in self._on_batch_added:
             try:
@@ -244,6 +1169,19 @@ class PointCloud:
             except Exception as e:
                 logger.error(f"Error in batch callback: {e}")
     
+    def get_stats(self) -> CloudStats:
+        """
+        Get per-axis statistics of the cloud.
+        
+        Combines the per-chunk summaries of the latest snapshot, so the cost
+        is proportional to the number of chunks, not points, and eviction
+        never forces a rescan.
+        
+        Returns:
+            CloudStats with count, min, max, mean and standard deviation
+        """
+        return self._snapshot.get_stats()
+    
     def get_bounds(self) -> Tuple[Tuple[float, float, float], Tuple[float, float, float]]:
         """
         Get the bounding box of the point cloud.
@@ -251,14 +1189,10 @@ class PointCloud:
         Returns:
             Tuple of (min_point, max_point) where each is (x, y, z)
         """
-        with self._lock:
-            if not self._points:
-                return ((0, 0, 0), (0, 0, 0))
-            
-            points = np.array([[p.x, p.y, p.z] for p in self._points])
-            min_pt = tuple(points.min(axis=0))
-            max_pt = tuple(points.max(axis=0))
-            return (min_pt, max_pt)
+        stats = self.get_stats()
+        if stats.count == 0:
+            return ((0, 0, 0), (0, 0, 0))
+        return (stats.min, stats.max)
     
     def get_center(self) -> Tuple[float, float, float]:
         """
@@ -267,13 +1201,7 @@ class PointCloud:
         Returns:
             Center point as (x, y, z)
         """
-        with self._lock:
-            if not self._points:
-                return (0.0, 0.0, 0.0)
-            
-            points = np.array([[p.x, p.y, p.z] for p in self._points])
-            center = points.mean(axis=0)
-            return tuple(center)
+        return self.get_stats().mean
     
     def __len__(self) -> int:
         """Return number of points."""
@@ -281,5 +1209,4 @@ class PointCloud:
     
     def __iter__(self):
         """Iterate over points."""
-        with self._lock:
-            return iter(list(self._points))
+        return iter(self.get_points())
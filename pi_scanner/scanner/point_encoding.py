@@ -0,0 +1,109 @@
+"""
+Compact canonical encoding of scan points.
+
+A reading is fully described by its raw distance and the servo/stepper
+angles it was taken at, so points are stored, spilled and sent as:
+- distance: uint16 millimeters
+- servo_index: uint16 servo angle in hundredths of a degree
+- stepper_index: uint16 stepper angle in hundredths of a degree (0-35999)
+- quality: uint8 sample quality (255 = unknown)
+
+That is 7 bytes per point. Cartesian coordinates are expanded from the
+encoding (through the direction table in use when the point was taken)
+only where floats are needed.
+"""
+
+from typing import Dict
+import numpy as np
+
+# Angle index units per degree
+ANGLE_SCALE = 100
+
+# Quality byte for readings without a quality estimate
+QUALITY_UNKNOWN = 255
+
+# Column name -> dtype of the encoded columns, in wire order
+ENCODED_COLUMNS = {
+    'distance': np.uint16,
+    'servo_index': np.uint16,
+    'stepper_index': np.uint16,
+    'quality': np.uint8,
+}
+
+_MAX_INDEX = np.iinfo(np.uint16).max
+_STEPPER_PERIOD = 360 * ANGLE_SCALE
+
+
+def encode_servo_angles(theta) -> np.ndarray:
+    """
+    Quantize servo angles to indices.
+    
+    Args:
+        theta: Servo angles in degrees (clamped to 0-655.35)
+    
+    Returns:
+        uint16 array of servo indices
+    """
+    index = np.rint(np.asarray(theta, dtype=np.float64) * ANGLE_SCALE)
+    return np.clip(index, 0, _MAX_INDEX).astype(np.uint16)
+
+
+def encode_stepper_angles(phi) -> np.ndarray:
+    """
+    Quantize stepper angles to indices, wrapping to one revolution.
+    
+    Args:
+        phi: Stepper angles in degrees
+    
+    Returns:
+        uint16 array of stepper indices (0-35999)
+    """
+    index = np.rint(np.asarray(phi, dtype=np.float64) * ANGLE_SCALE).astype(np.int64)
+    return (index % _STEPPER_PERIOD).astype(np.uint16)
+
+
+def encode_distances(distance) -> np.ndarray:
+    """
+    Round distances to whole millimeters.
+    
+    Args:
+        distance: Distances in millimeters
+    
+    Returns:
+        uint16 array of distances (saturating at 65535)
+    """
+    distance = np.rint(np.asarray(distance, dtype=np.float64))
+    return np.clip(distance, 0, _MAX_INDEX).astype(np.uint16)
+
+
+def decode_angles(index: np.ndarray) -> np.ndarray:
+    """
+    Expand angle indices to degrees.
+    
+    Args:
+        index: Servo or stepper indices
+    
+    Returns:
+        float64 array of angles in degrees
+    """
+    return np.asarray(index, dtype=np.float64) / ANGLE_SCALE
+
+
+def pack_columns(columns: Dict[str, np.ndarray]) -> bytes:
+    """
+    Pack encoded columns into one little-endian binary frame.
+    
+    The columns are laid out back to back (distance, servo_index,
+    stepper_index, quality) so a reader can wrap each one in a typed array
+    without copying; the 16-bit columns come first and stay aligned.
+    
+    Args:
+        columns: Encoded columns keyed by name, all of the same length
+    
+    Returns:
+        7 bytes per point
+    """
+    return b''.join(
+        np.ascontiguousarray(columns[name], dtype=np.dtype(dtype).newbyteorder('<')).tobytes()
+        for name, dtype in ENCODED_COLUMNS.items()
+    )
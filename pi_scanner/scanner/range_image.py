@@ -0,0 +1,331 @@
+"""
+Organized range-image store indexed by (servo step, stepper step).
+
+The scan is a regular grid of servo (theta) by stepper (phi) angles, so raw
+distances are kept in a dense 2D array and Cartesian coordinates, neighbours,
+normals and filters are all derived by array indexing.
+"""
+
+import logging
+import threading
+import warnings
+from typing import Optional, Tuple
+import numpy as np
+
+from .direction_table import DirectionTable
+from ..config import (
+    SCAN_SERVO_START,
+    SCAN_SERVO_END,
+    SCAN_STEPPER_TOTAL,
+    STEPPER_DEGREES_PER_INCREMENT
+)
+
+logger = logging.getLogger(__name__)
+
+# Sample count saturates at this value (uint8 storage)
+MAX_SAMPLE_COUNT = 255
+
+
+class RangeImage:
+    """
+    Dense 2D range image for an organized scan.
+    
+    Rows are servo angles (theta), columns are stepper angles (phi).
+    Per cell:
+    - range: uint16 mean distance in mm (0 = no data)
+    - count: uint8 number of samples averaged into the cell
+    - quality: uint8 quality of the latest sample (0-255)
+    
+    The phi axis wraps around, so column neighbours of the last column
+    are in the first column.
+    """
+    
+    def __init__(self,
+                 theta_start: float = SCAN_SERVO_START,
+                 theta_end: float = SCAN_SERVO_END,
+                 theta_step: float = 1.0,
+                 phi_total: float = SCAN_STEPPER_TOTAL,
+                 phi_step: float = STEPPER_DEGREES_PER_INCREMENT):
+        """
+        Initialize the range image.
+        
+        Args:
+            theta_start: Servo angle of the first row in degrees
+            theta_end: Servo angle of the last row in degrees
+            theta_step: Servo angle between rows in degrees
+            phi_total: Stepper angle covered by all columns in degrees
+            phi_step: Stepper angle between columns in degrees
+        """
+        self.theta_start = theta_start
+        self.theta_step = theta_step
+        self.phi_step = phi_step
+        self.rows = int(round((theta_end - theta_start) / theta_step)) + 1
+        self.cols = int(round(phi_total / phi_step))
+        
+        self._lock = threading.Lock()
+        self._range = np.zeros((self.rows, self.cols), dtype=np.uint16)
+        self._count = np.zeros((self.rows, self.cols), dtype=np.uint8)
+        self._quality = np.zeros((self.rows, self.cols), dtype=np.uint8)
+        
+        # Optional precomputed (possibly calibrated) ray table for this grid
+        self.direction_table: Optional[DirectionTable] = None
+    
+    @property
+    def shape(self) -> Tuple[int, int]:
+        """Get (rows, cols) of the image."""
+        return (self.rows, self.cols)
+    
+    def cell_index(self, theta: float, phi: float) -> Optional[Tuple[int, int]]:
+        """
+        Map servo/stepper angles to a cell.
+        
+        Args:
+            theta: Servo angle in degrees
+            phi: Stepper angle in degrees
+        
+        Returns:
+            (row, col) tuple, or None if theta is outside the image
+        """
+        row = int(round((theta - self.theta_start) / self.theta_step))
+        if row < 0 or row >= self.rows:
+            return None
+        col = int(round(phi / self.phi_step)) % self.cols
+        return (row, col)
+    
+    def cell_angles(self) -> Tuple[np.ndarray, np.ndarray]:
+        """
+        Get the servo and stepper angle of every row and column.
+        
+        Returns:
+            Tuple of (theta per row, phi per column) in degrees
+        """
+        theta = self.theta_start + np.arange(self.rows) * self.theta_step
+        phi = np.arange(self.cols) * self.phi_step
+        return (theta, phi)
+    
+    def add(self, theta: float, phi: float, distance: float, quality: int = 255) -> bool:
+        """
+        Add a distance sample to its cell.
+        
+        Repeated samples of the same cell (e.g. forward and reverse sweeps)
+        are averaged.
+        
+        Args:
+            theta: Servo angle in degrees
+            phi: Stepper angle in degrees
+            distance: Distance in millimeters
+            quality: Sample quality (0-255)
+        
+        Returns:
+            True if the sample landed in the image
+        """
+        cell = self.cell_index(theta, phi)
+        if cell is None:
+            return False
+        
+        with self._lock:
+            n = int(self._count[cell])
+            if n == 0:
+                self._range[cell] = distance
+            else:
+                mean = int(self._range[cell])
+                self._range[cell] = int(round(mean + (distance - mean) / (n + 1)))
+            self._count[cell] = min(n + 1, MAX_SAMPLE_COUNT)
+            self._quality[cell] = quality
+        return True
+    
+    def add_batch(self, theta: np.ndarray, phi: np.ndarray,
+                  distance: np.ndarray, quality: int = 255) -> int:
+        """
+        Add many distance samples at once.
+        
+        Args:
+            theta: Servo angles in degrees (N,)
+            phi: Stepper angles in degrees (N,)
+            distance: Distances in millimeters (N,)
+            quality: Sample quality (0-255) for all samples
+            
+        Returns:
+            Number of samples that landed in the image
+        """
+        rows = np.rint((np.asarray(theta, dtype=np.float64) - self.theta_start)
+                       / self.theta_step).astype(np.int64)
+        cols = np.rint(np.asarray(phi, dtype=np.float64) / self.phi_step).astype(np.int64) % self.cols
+        inside = (rows >= 0) & (rows < self.rows)
+        if not inside.any():
+            return 0
+        
+        # Fold duplicate cells within the batch into one update each
+        flat = rows[inside] * self.cols + cols[inside]
+        cells, inverse = np.unique(flat, return_inverse=True)
+        added = np.bincount(inverse).astype(np.int64)
+        sums = np.bincount(inverse, weights=np.asarray(distance, dtype=np.float64)[inside])
+        
+        with self._lock:
+            ranges = self._range.reshape(-1)
+            counts = self._count.reshape(-1)
+            n = counts[cells].astype(np.int64)
+            mean = (ranges[cells] * n + sums) / (n + added)
+            ranges[cells] = np.rint(mean).astype(np.uint16)
+            counts[cells] = np.minimum(n + added, MAX_SAMPLE_COUNT)
+            self._quality.reshape(-1)[cells] = quality
+        return int(inside.sum())
+    
+    def get_range(self, row: int, col: int) -> int:
+        """
+        Get the range of a single cell.
+        
+        Returns:
+            Distance in millimeters (0 = no data)
+        """
+        return int(self._range[row, col % self.cols])
+    
+    def get_ranges(self) -> np.ndarray:
+        """
+        Get a read-only view of the range image (rows x cols, uint16 mm).
+        """
+        view = self._range.view()
+        view.flags.writeable = False
+        return view
+    
+    def get_counts(self) -> np.ndarray:
+        """
+        Get a read-only view of the per-cell sample counts.
+        """
+        view = self._count.view()
+        view.flags.writeable = False
+        return view
+    
+    def get_quality(self) -> np.ndarray:
+        """
+        Get a read-only view of the per-cell quality.
+        """
+        view = self._quality.view()
+        view.flags.writeable = False
+        return view
+    
+    def get_valid_mask(self) -> np.ndarray:
+        """
+        Get a boolean mask of cells holding at least one sample.
+        """
+        return self._count > 0
+    
+    def get_neighbors(self, row: int, col: int, radius: int = 1) -> np.ndarray:
+        """
+        Get the ranges around a cell.
+        
+        Rows beyond the image edge are zero (no data); columns wrap around.
+        
+        Args:
+            row, col: Center cell
+            radius: Half-size of the window
+        
+        Returns:
+            Array of shape (2 * radius + 1, 2 * radius + 1) with ranges in mm
+        """
+        size = 2 * radius + 1
+        window = np.zeros((size, size), dtype=np.uint16)
+        cols = np.arange(col - radius, col + radius + 1) % self.cols
+        for i, r in enumerate(range(row - radius, row + radius + 1)):
+            if 0 <= r < self.rows:
+                window[i] = self._range[r, cols]
+        return window
+    
+    def _has_table(self) -> bool:
+        """Check if a direction table matching this grid is attached."""
+        return self.direction_table is not None and self.direction_table.shape == self.shape
+    
+    def directions(self) -> np.ndarray:
+        """
+        Get the unit direction vector of every cell.
+        
+        Returns:
+            Array of shape (rows, cols, 3)
+        """
+        if self._has_table():
+            return self.direction_table.get_directions()
+        
+        theta, phi = self.cell_angles()
+        theta = np.radians(theta)[:, None]
+        phi = np.radians(phi)[None, :]
+        sin_theta = np.sin(theta)
+        return np.stack(np.broadcast_arrays(
+            sin_theta * np.cos(phi),
+            sin_theta * np.sin(phi),
+            np.cos(theta)
+        ), axis=-1)
+    
+    def to_cartesian(self) -> np.ndarray:
+        """
+        Convert the range image to an organized Cartesian grid.
+        
+        Uses the same coordinate system as PointCloud.spherical_to_cartesian.
+        
+        Returns:
+            Float32 array of shape (rows, cols, 3); empty cells are NaN
+        """
+        ranges = self._range.astype(np.float32)
+        ranges[self._count == 0] = np.nan
+        xyz = self.directions() * ranges[:, :, None]
+        if self._has_table() and not self.direction_table.model.is_ideal:
+            xyz += self.direction_table.get_origins()
+        return xyz.astype(np.float32)
+    
+    def estimate_normals(self) -> np.ndarray:
+        """
+        Estimate surface normals from grid neighbours.
+        
+        The normal of each cell is the cross product of the vectors to its
+        next row and next column neighbour, oriented towards the scanner.
+        
+        Returns:
+            Float32 array of shape (rows, cols, 3); NaN where undefined
+        """
+        xyz = self.to_cartesian()
+        d_row = np.full_like(xyz, np.nan)
+        d_row[:-1] = xyz[1:] - xyz[:-1]
+        d_col = np.roll(xyz, -1, axis=1) - xyz
+        
+        normals = np.cross(d_row, d_col)
+        length = np.linalg.norm(normals, axis=-1, keepdims=True)
+        with np.errstate(invalid='ignore', divide='ignore'):
+            normals = normals / length
+            
+            # Flip normals facing away from the origin
+            facing = np.sum(normals * xyz, axis=-1, keepdims=True)
+            normals = np.where(facing > 0, -normals, normals)
+        return normals.astype(np.float32)
+    
+    def filter_outliers(self, max_deviation: float = 100.0) -> np.ndarray:
+        """
+        Find isolated samples that disagree with their 3x3 neighbourhood.
+        
+        Args:
+            max_deviation: Maximum allowed difference from the local median in mm
+        
+        Returns:
+            Boolean mask of cells that are valid and not outliers
+        """
+        ranges = self._range.astype(np.float32)
+        valid = self._count > 0
+        ranges[~valid] = np.nan
+        
+        padded = np.full((self.rows + 2, self.cols), np.nan, dtype=np.float32)
+        padded[1:-1] = ranges
+        windows = [
+            np.roll(padded[1 + dr:self.rows + 1 + dr], dc, axis=1)
+            for dr in (-1, 0, 1) for dc in (-1, 0, 1)
+        ]
+        with warnings.catch_warnings():
+            # All-NaN neighbourhoods produce a NaN median
+            warnings.simplefilter('ignore', RuntimeWarning)
+            median = np.nanmedian(np.stack(windows), axis=0)
+        with np.errstate(invalid='ignore'):
+            return valid & ~(np.abs(ranges - median) > max_deviation)
+    
+    def clear(self):
+        """Clear all cells."""
+        with self._lock:
+            self._range.fill(0)
+            self._count.fill(0)
+            self._quality.fill(0)
@@ -0,0 +1,192 @@
+"""
+Pause/resume/stop signalling between the web thread and the scan thread.
+
+Commands are flags guarded by a condition variable. Every wait of the scan
+thread (settle times, latch timing, paused) is a wait on that condition,
+so a command wakes it at once instead of at the next poll; waits on other
+primitives (the reading queue, stepper moves) are woken through request
+callbacks. The time from each command to the scan thread acting on it is
+kept to report the command latency.
+"""
+
+import logging
+import math
+from collections import deque
+from typing import Callable, Dict, List
+
+from ..hardware import Clock, SYSTEM_CLOCK
+
+logger = logging.getLogger(__name__)
+
+# Latencies kept per command for the percentiles
+LATENCY_HISTORY = 1000
+
+
+class ScanControl:
+    """
+    Scan commands with cancellable waits.
+    
+    The web thread calls request_pause(), request_resume() and
+    request_stop(). The scan thread waits with sleep_until() and hold(),
+    which return early when a command arrives, and polls interrupted()
+    inside long operations it cannot wait on.
+    """
+    
+    def __init__(self, history: int = LATENCY_HISTORY, clock: Clock = SYSTEM_CLOCK):
+        """
+        Initialize with no command pending.
+        
+        Args:
+            history: Number of latencies kept per command
+            clock: Time source for the waits and latencies
+        """
+        self.clock = clock
+        self._condition = clock.condition()
+        self._paused = False
+        self._stopped = False
+        self._requested: Dict[str, float] = {}  # command -> clock time of the request
+        self._latencies = {name: deque(maxlen=history) for name in ('pause', 'resume', 'stop')}
+        self._wakers: List[Callable[[], None]] = []
+    
+    def on_request(self, callback: Callable[[], None]):
+        """Register a callback that wakes a scan thread wait on another primitive."""
+        self._wakers.append(callback)
+    
+    def reset(self):
+        """Clear the commands for a new scan."""
+        with self._condition:
+            self._paused = False
+            self._stopped = False
+            self._requested.clear()
+    
+    def request_pause(self):
+        """Ask the scan thread to halt where it is."""
+        self._request('pause', paused=True)
+    
+    def request_resume(self):
+        """Ask a paused scan thread to carry on."""
+        self._request('resume', paused=False)
+    
+    def request_stop(self):
+        """Ask the scan thread to finish; also releases a pause."""
+        self._request('stop', stopped=True)
+    
+    def _request(self, command: str, paused=None, stopped=None):
+        """Set the flags of a command and wake the scan thread."""
+        with self._condition:
+            if paused is not None:
+                self._paused = paused
+            if stopped is not None:
+                self._stopped = stopped
+            self._requested[command] = self.clock.monotonic()
+            self._condition.notify_all()
+        for callback in self._wakers:
+            try:
+                callback()
+            except Exception as e:
+                logger.error(f"Error in scan control waker: {e}")
+    
+    @property
+    def paused(self) -> bool:
+        """Check if a pause is in effect."""
+        return self._paused
+    
+    @property
+    def stopped(self) -> bool:
+        """Check if a stop was requested."""
+        return self._stopped
+    
+    def interrupted(self) -> bool:
+        """Check if the scan thread should break off what it is doing."""
+        return self._paused or self._stopped
+    
+    def check(self) -> bool:
+        """
+        Check if the scan thread should carry on (scan thread only).
+        
+        Returns:
+            False if a stop was requested
+        """
+        with self._condition:
+            if self._stopped:
+                self._acknowledge('stop')
+                return False
+            return True
+    
+    def sleep_until(self, deadline: float) -> bool:
+        """
+        Sleep until a clock time unless a command arrives (scan thread only).
+        
+        Returns:
+            True if the deadline was reached, False if paused or stopped
+        """
+        with self._condition:
+            while not (self._paused or self._stopped):
+                remaining = deadline - self.clock.monotonic()
+                if remaining <= 0:
+                    return True
+                self._condition.wait(remaining)
+        self.check()
+        return False
+    
+    def sleep(self, seconds: float) -> bool:
+        """
+        Sleep unless a command arrives (scan thread only).
+        
+        Returns:
+            True if the time elapsed, False if paused or stopped
+        """
+        return self.sleep_until(self.clock.monotonic() + seconds)
+    
+    def hold(self) -> bool:
+        """
+        Block while paused (scan thread only).
+        
+        Call once the scan has come to rest; the pause counts as taking
+        effect here.
+        
+        Returns:
+            True to carry on, False if a stop was requested
+        """
+        with self._condition:
+            if self._paused and not self._stopped:
+                self._acknowledge('pause')
+                while self._paused and not self._stopped:
+                    self._condition.wait()
+                if not self._stopped:
+                    self._acknowledge('resume')
+        return self.check()
+    
+    def _acknowledge(self, command: str):
+        """Record the latency of a command the scan thread acted on."""
+        requested = self._requested.pop(command, None)
+        if requested is not None:
+            self._latencies[command].append(self.clock.monotonic() - requested)
+    
+    def latency(self) -> dict:
+        """
+        Get the command latencies (request to the scan thread acting on it).
+        
+        Returns:
+            Per command: count, p50_ms, p99_ms and max_ms of the latest
+            LATENCY_HISTORY commands
+        """
+        with self._condition:
+            samples = {command: sorted(values) for command, values in self._latencies.items()}
+        
+        result = {}
+        for command, values in samples.items():
+            if not values:
+                result[command] = {'count': 0, 'p50_ms': None, 'p99_ms': None, 'max_ms': None}
+                continue
+            
+            def percentile(p: float) -> float:
+                return values[max(0, math.ceil(p * len(values)) - 1)] * 1000
+            
+            result[command] = {
+                'count': len(values),
+                'p50_ms': percentile(0.50),
+                'p99_ms': percentile(0.99),
+                'max_ms': values[-1] * 1000
+            }
+        return result
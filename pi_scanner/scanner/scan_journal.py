@@ -0,0 +1,285 @@
+"""
+Crash-safe append-only journal of a scan in progress.
+
+The coordinator appends every batch of readings it adds to the cloud and,
+after each completed schedule row, a checkpoint with the scan position.
+Writes are buffered and fsync'd in batches, so a crash or brown-out loses
+at most the last few rows. An interrupted scan is resumed by rebuilding the
+cloud from the readings up to the last checkpoint and continuing from the
+row after it; readings of the row under way at the crash are dropped and
+that row is scanned again.
+
+File layout:
+- 8-byte magic b'SEYEJRN1'
+- u32 length, then a UTF-8 JSON header (scan plan and settings)
+- records: u8 type, u32 payload length, u32 CRC-32 of the payload, payload
+  - RECORD_POINTS: theta f4[n], phi f4[n], distance u16[n]
+  - RECORD_CHECKPOINT: CHECKPOINT_FORMAT
+  - RECORD_COMPLETE: empty; the scan finished
+  - RECORD_REFINEMENT: REFINEMENT_SHAPE, then the flagged survey samples of
+    an adaptive scan as packed bits; written as the refinement starts, so a
+    resumed refinement follows the schedule it was started with
+A record that is cut short or fails its CRC ends the journal.
+"""
+
+import json
+import logging
+import mmap
+import os
+import struct
+import time
+import zlib
+from dataclasses import dataclass
+from typing import List, Optional
+import numpy as np
+
+from ..config import SCAN_JOURNAL_SYNC_ROWS, SCAN_JOURNAL_SYNC_INTERVAL
+
+logger = logging.getLogger(__name__)
+
+JOURNAL_MAGIC = b'SEYEJRN1'
+
+# Record header: type, payload length, CRC-32 of the payload
+RECORD_HEADER = struct.Struct('<BII')
+
+RECORD_POINTS = 1
+RECORD_CHECKPOINT = 2
+RECORD_COMPLETE = 3
+RECORD_REFINEMENT = 4
+
+# Phase (0 survey, 1 refinement), rows of the phase completed, progress
+# cycle, stepper angle in degrees
+CHECKPOINT_FORMAT = struct.Struct('<BIId')
+
+# Rows and columns of the flagged survey samples
+REFINEMENT_SHAPE = struct.Struct('<II')
+
+# Bytes per journalled reading (theta f4, phi f4, distance u16)
+POINT_BYTES = 10
+
+
+@dataclass
+class Checkpoint:
+    """Scan position after a completed schedule row."""
+    phase: int            # 0: survey (the plan's schedule), 1: adaptive refinement
+    rows: int             # Rows of the phase's schedule completed
+    cycle: int            # Progress cycle reached
+    stepper_angle: float  # Stepper angle in degrees
+
+
+@dataclass
+class RecoveredScan:
+    """Contents of a journal up to its last checkpoint."""
+    metadata: dict
+    theta: np.ndarray        # float32 (N,)
+    phi: np.ndarray          # float32 (N,)
+    distance: np.ndarray     # uint16 (N,)
+    checkpoint: Optional[Checkpoint]
+    refinement: Optional[np.ndarray]  # bool (rows, cols) flagged survey samples
+    complete: bool
+    end_offset: int          # File offset just past the last checkpoint
+
+
+class ScanJournal:
+    """
+    Writer of a scan journal.
+    
+    Only the scan thread writes. Records are buffered; the file is flushed
+    and fsync'd every SCAN_JOURNAL_SYNC_ROWS checkpoints or
+    SCAN_JOURNAL_SYNC_INTERVAL seconds, and on close.
+    """
+    
+    def __init__(self, filepath: str, metadata: Optional[dict] = None,
+                 offset: Optional[int] = None):
+        """
+        Start a new journal, or continue an existing one.
+        
+        Args:
+            filepath: Path of the journal
+            metadata: Scan description for the header of a new journal
+            offset: Continue the existing journal, dropping everything
+                    from this offset on (see RecoveredScan.end_offset)
+        
+        Raises:
+            OSError: If the file cannot be written
+        """
+        self.filepath = filepath
+        self._unsynced_rows = 0
+        self._last_sync = time.monotonic()
+        
+        if offset is None:
+            directory = os.path.dirname(filepath)
+            if directory:
+                os.makedirs(directory, exist_ok=True)
+            self._file = open(filepath, 'wb')
+            header = json.dumps(metadata or {}).encode('utf-8')
+            self._file.write(JOURNAL_MAGIC)
+            self._file.write(struct.pack('<I', len(header)))
+            self._file.write(header)
+        else:
+            self._file = open(filepath, 'r+b')
+            self._file.truncate(offset)
+            self._file.seek(offset)
+        self.sync()
+    
+    def _write(self, record_type: int, payload: bytes):
+        """Append one record."""
+        self._file.write(RECORD_HEADER.pack(record_type, len(payload), zlib.crc32(payload)))
+        self._file.write(payload)
+    
+    def append_points(self, theta, phi, distance):
+        """
+        Append a batch of readings.
+        
+        Args:
+            theta: Servo angles in degrees (N,)
+            phi: Stepper angles in degrees (N,)
+            distance: Distances in mm (N,)
+        """
+        payload = b''.join((
+            np.asarray(theta, dtype='<f4').tobytes(),
+            np.asarray(phi, dtype='<f4').tobytes(),
+            np.clip(np.asarray(distance), 0, 0xFFFF).astype('<u2').tobytes()
+        ))
+        self._write(RECORD_POINTS, payload)
+    
+    def checkpoint(self, checkpoint: Checkpoint):
+        """Commit the readings so far with the scan position after them."""
+        self._write(RECORD_CHECKPOINT, CHECKPOINT_FORMAT.pack(
+            checkpoint.phase, checkpoint.rows, checkpoint.cycle, checkpoint.stepper_angle))
+        self._unsynced_rows += 1
+        if (self._unsynced_rows >= SCAN_JOURNAL_SYNC_ROWS
+                or time.monotonic() - self._last_sync >= SCAN_JOURNAL_SYNC_INTERVAL):
+            self.sync()
+    
+    def refinement(self, flagged: np.ndarray):
+        """
+        Record the survey samples an adaptive scan's refinement covers.
+        
+        Args:
+            flagged: Boolean array of flagged coarse samples (rows x cols)
+        """
+        flagged = np.asarray(flagged, dtype=bool)
+        self._write(RECORD_REFINEMENT, REFINEMENT_SHAPE.pack(*flagged.shape)
+                    + np.packbits(flagged, axis=None).tobytes())
+    
+    def complete(self):
+        """Mark the scan as finished; there is nothing left to resume."""
+        self._write(RECORD_COMPLETE, b'')
+        self.sync()
+    
+    def sync(self):
+        """Write buffered records through to the disk."""
+        self._file.flush()
+        os.fsync(self._file.fileno())
+        self._unsynced_rows = 0
+        self._last_sync = time.monotonic()
+    
+    def close(self):
+        """Sync and close the journal."""
+        if self._file is None:
+            return
+        try:
+            self.sync()
+        finally:
+            self._file.close()
+            self._file = None
+
+
+def recover_journal(filepath: str) -> Optional[RecoveredScan]:
+    """
+    Read a journal in a single pass over a read-only mapping.
+    
+    Args:
+        filepath: Path of the journal
+    
+    Returns:
+        The readings and position up to the last checkpoint, or None if
+        there is no valid journal
+    """
+    try:
+        with open(filepath, 'rb') as f:
+            size = os.fstat(f.fileno()).st_size
+            if size < len(JOURNAL_MAGIC) + 4:
+                logger.warning(f"No scan journal at {filepath}")
+                return None
+            data = mmap.mmap(f.fileno(), 0, access=mmap.ACCESS_READ)
+    except OSError as e:
+        logger.warning(f"Cannot open scan journal {filepath}: {e}")
+        return None
+    
+    try:
+        if data[:len(JOURNAL_MAGIC)] != JOURNAL_MAGIC:
+            logger.error(f"Not a scan journal: {filepath}")
+            return None
+        offset = len(JOURNAL_MAGIC)
+        (length,) = struct.unpack_from('<I', data, offset)
+        offset += 4
+        try:
+            metadata = json.loads(bytes(data[offset:offset + length]).decode('utf-8'))
+        except ValueError as e:
+            logger.error(f"Corrupt scan journal header in {filepath}: {e}")
+            return None
+        offset += length
+        
+        committed: List[tuple] = []   # (offset, count) of checkpointed batches
+        pending: List[tuple] = []
+        checkpoint = None
+        refinement = None
+        pending_refinement = None
+        complete = False
+        end_offset = offset
+        while offset + RECORD_HEADER.size <= size:
+            record_type, length, crc = RECORD_HEADER.unpack_from(data, offset)
+            start = offset + RECORD_HEADER.size
+            if start + length > size or zlib.crc32(data[start:start + length]) != crc:
+                logger.warning(f"Scan journal ends in a torn record at byte {offset}")
+                break
+            offset = start + length
+            
+            if record_type == RECORD_POINTS and length % POINT_BYTES == 0:
+                pending.append((start, length // POINT_BYTES))
+            elif record_type == RECORD_CHECKPOINT and length == CHECKPOINT_FORMAT.size:
+                checkpoint = Checkpoint(*CHECKPOINT_FORMAT.unpack_from(data, start))
+                committed.extend(pending)
+                pending = []
+                if pending_refinement is not None:
+                    refinement, pending_refinement = pending_refinement, None
+                end_offset = offset
+            elif record_type == RECORD_REFINEMENT and length >= REFINEMENT_SHAPE.size:
+                rows, cols = REFINEMENT_SHAPE.unpack_from(data, start)
+                if length != REFINEMENT_SHAPE.size + (rows * cols + 7) // 8:
+                    logger.warning(f"Malformed scan journal record at byte {start - RECORD_HEADER.size}")
+                    break
+                # Copied out, so no buffer of the mapping outlives it
+                bits = np.frombuffer(bytes(data[start + REFINEMENT_SHAPE.size:start + length]),
+                                     dtype=np.uint8)
+                pending_refinement = np.unpackbits(bits, count=rows * cols).astype(bool).reshape(rows, cols)
+            elif record_type == RECORD_COMPLETE:
+                complete = True
+                end_offset = offset
+            else:
+                logger.warning(f"Unknown scan journal record at byte {start - RECORD_HEADER.size}")
+                break
+        
+        # Copy the committed columns out of the mapping
+        total = sum(count for _start, count in committed)
+        theta = np.empty(total, dtype=np.float32)
+        phi = np.empty(total, dtype=np.float32)
+        distance = np.empty(total, dtype=np.uint16)
+        at = 0
+        for start, count in committed:
+            theta[at:at + count] = np.frombuffer(data, dtype='<f4', count=count, offset=start)
+            phi[at:at + count] = np.frombuffer(data, dtype='<f4', count=count, offset=start + 4 * count)
+            distance[at:at + count] = np.frombuffer(data, dtype='<u2', count=count, offset=start + 8 * count)
+            at += count
+    except (struct.error, ValueError) as e:
+        logger.error(f"Corrupt scan journal {filepath}: {e}")
+        return None
+    finally:
+        data.close()
+    
+    logger.info(f"Recovered {total} readings from scan journal {filepath}"
+                + (" (complete)" if complete else ""))
+    return RecoveredScan(metadata, theta, phi, distance, checkpoint, refinement,
+                         complete, end_offset)
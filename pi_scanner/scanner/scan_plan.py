@@ -0,0 +1,350 @@
+"""
+Declarative scan plans compiled into motion schedules.
+
+A ScanPlan describes what to scan: the elevation (servo) and azimuth
+(stepper) windows, the step size along each axis and the order in which
+the grid is visited. compile() turns it into a MotionSchedule, the exact
+sequence of (servo target, stepper target, dwell) moves the coordinator
+executes, grouped into rows that each move along one axis only.
+"""
+
+import bisect
+import math
+from dataclasses import dataclass, asdict, fields, replace
+from typing import Iterator, List, Optional, Tuple
+
+from ..config import (
+    SCAN_SERVO_START,
+    SCAN_SERVO_END,
+    SCAN_STEPPER_TOTAL,
+    SCAN_PATTERN,
+    SCAN_DELAY_AT_ENDS,
+    ADAPTIVE_REFINE_STEP,
+    ADAPTIVE_REFINE_THRESHOLD,
+    SERVO_MIN_ANGLE,
+    SERVO_MAX_ANGLE,
+    SERVO_SETTLE_TIME,
+    STEPPER_DEGREES_PER_INCREMENT,
+    STEPPER_STEPS_PER_REVOLUTION
+)
+
+# Supported visiting orders
+# - raster: sweep the servo up and back down at every stepper angle
+# - serpentine: one servo sweep per stepper angle, alternating direction
+# - spiral: one stepper pass per servo angle, always turning the same way,
+#   so a full-circle azimuth window becomes one continuous helix
+# - progressive: serpentine sweeps visiting the stepper angles coarse to
+#   fine (0°, 180°, 90°, 270°, 45°, ...), so the whole scene appears early
+#   at a low resolution that keeps halving
+SCAN_ORDERS = ('raster', 'serpentine', 'spiral', 'progressive')
+
+# Tolerance when counting grid steps in a window (degrees)
+_EPSILON = 1e-9
+
+# Fields that are not numbers
+_NON_NUMERIC = ('order', 'adaptive')
+
+
+def _is_multiple(value: float, step: float) -> bool:
+    """Check if value is a whole multiple of step."""
+    ratio = value / step
+    return abs(ratio - round(ratio)) <= 1e-6
+
+
+def progressive_order(count: int) -> List[int]:
+    """
+    Order indices coarse to fine (bit-reversal / van der Corput order).
+    
+    Index k of the result is the position floor(count * b(k) / 2^n), where
+    b(k) reverses the n bits of k and 2^n >= count, skipping positions
+    already taken. Every prefix is spread evenly over the range.
+    
+    Args:
+        count: Number of indices
+    
+    Returns:
+        Permutation of range(count), e.g. 0, 4, 2, 6, 1, 5, 3, 7 for 8
+    """
+    if count <= 0:
+        return []
+    bits = (count - 1).bit_length()
+    order: List[int] = []
+    taken = set()
+    for k in range(1 << bits):
+        reversed_k = int(format(k, f'0{bits}b')[::-1], 2) if bits else 0
+        index = (reversed_k * count) >> bits
+        if index not in taken:
+            taken.add(index)
+            order.append(index)
+    return order
+
+
+class AxisCoverage:
+    """
+    Angles of one axis scanned so far, for the effective resolution.
+    
+    The effective resolution is the widest gap between scanned angles
+    (including the gaps to the window ends, or across 0° on a full circle):
+    the scan has sampled the window at least that densely.
+    """
+    
+    def __init__(self, start: float, span: float, wrap: bool):
+        """
+        Initialize empty coverage.
+        
+        Args:
+            start: First angle of the window in degrees
+            span: Angle from the first to the last grid angle (360 if wrap)
+            wrap: True if the window is a full circle
+        """
+        self.start = start
+        self.span = span
+        self.wrap = wrap
+        self._offsets: List[float] = []
+    
+    def add(self, angle: float):
+        """Mark an angle as scanned."""
+        offset = round((angle - self.start) % 360, 6)
+        position = bisect.bisect_left(self._offsets, offset)
+        if position == len(self._offsets) or self._offsets[position] != offset:
+            self._offsets.insert(position, offset)
+    
+    @property
+    def resolution(self) -> Optional[float]:
+        """Get the widest gap between scanned angles (None before any)."""
+        offsets = self._offsets
+        if not offsets:
+            return None
+        gaps = [b - a for a, b in zip(offsets, offsets[1:])]
+        if self.wrap:
+            gaps.append(offsets[0] + 360 - offsets[-1])
+        else:
+            gaps += [offsets[0], self.span - offsets[-1]]
+        return max(gaps)
+
+
+@dataclass(frozen=True)
+class MotionStep:
+    """One scheduled reading: move both axes, wait, then measure."""
+    servo: float     # Servo target in degrees
+    stepper: float   # Stepper target in degrees (0-360)
+    dwell: float     # Wait after reaching the targets, before reading (seconds)
+
+
+@dataclass
+class ScanRow:
+    """Consecutive steps that move along one axis only."""
+    axis: str                 # 'servo' (servo sweep) or 'stepper' (stepper pass)
+    cycle: int                # Index of the outer-axis position this row belongs to
+    steps: List[MotionStep]
+    
+    @property
+    def servo_angles(self) -> List[float]:
+        """Get the servo target of every step."""
+        return [step.servo for step in self.steps]
+
+
+@dataclass
+class MotionSchedule:
+    """Precomputed moves of a scan plan, grouped into rows."""
+    rows: List[ScanRow]
+    cycles: int   # Number of outer-axis positions (progress denominator)
+    
+    def __len__(self) -> int:
+        """Get the number of readings scheduled."""
+        return sum(len(row.steps) for row in self.rows)
+    
+    def steps(self) -> Iterator[MotionStep]:
+        """Iterate over all steps in execution order."""
+        for row in self.rows:
+            yield from row.steps
+
+
+@dataclass
+class ScanPlan:
+    """
+    What to scan and in which order.
+    
+    Elevation is the servo angle (0° = up); the window includes both ends.
+    Azimuth is the stepper angle; a window spanning 360° is a full circle
+    (the end is not repeated), a smaller one includes both ends and may
+    cross 0° (e.g. 315 to 405).
+    
+    An adaptive plan scans its window at theta_step x phi_step as a coarse
+    survey, then refines at refine_step around depth edges found in the
+    survey (see adaptive.py). Its organized grid is the fine one.
+    """
+    theta_start: float = SCAN_SERVO_START   # Elevation window start (degrees)
+    theta_end: float = SCAN_SERVO_END       # Elevation window end (degrees)
+    phi_start: float = 0.0                  # Azimuth window start (degrees)
+    phi_end: float = SCAN_STEPPER_TOTAL     # Azimuth window end (degrees)
+    theta_step: float = 1.0                 # Servo step (degrees)
+    phi_step: float = STEPPER_DEGREES_PER_INCREMENT  # Stepper step (degrees)
+    order: str = SCAN_PATTERN               # One of SCAN_ORDERS
+    settle: float = SERVO_SETTLE_TIME       # Dwell after each step (seconds)
+    end_dwell: float = SCAN_DELAY_AT_ENDS   # Dwell before the first step of each row (seconds)
+    adaptive: bool = False                  # Coarse survey, then refine edges
+    refine_step: float = ADAPTIVE_REFINE_STEP            # Fine step (degrees)
+    refine_threshold: float = ADAPTIVE_REFINE_THRESHOLD  # Relative edge threshold
+    
+    def __post_init__(self):
+        """Validate the plan."""
+        for field in fields(self):
+            if field.name not in _NON_NUMERIC:
+                value = float(getattr(self, field.name))
+                if not math.isfinite(value):
+                    raise ValueError(f"{field.name} must be a finite number")
+                setattr(self, field.name, value)
+        
+        if self.order not in SCAN_ORDERS:
+            raise ValueError(f"order must be one of {', '.join(SCAN_ORDERS)}")
+        if not SERVO_MIN_ANGLE <= self.theta_start <= self.theta_end <= SERVO_MAX_ANGLE:
+            raise ValueError(
+                f"Elevation window must satisfy {SERVO_MIN_ANGLE} <= theta_start "
+                f"<= theta_end <= {SERVO_MAX_ANGLE}")
+        if not 0 <= self.phi_start < 360:
+            raise ValueError("phi_start must be in [0, 360)")
+        if not self.phi_start <= self.phi_end <= self.phi_start + 360:
+            raise ValueError("Azimuth window must satisfy phi_start <= phi_end <= phi_start + 360")
+        if self.theta_step <= 0:
+            raise ValueError("theta_step must be positive")
+        if self.phi_step < 360.0 / STEPPER_STEPS_PER_REVOLUTION:
+            raise ValueError("phi_step is finer than one stepper step")
+        # The organized grid has columns at multiples of phi_step around the circle
+        if not _is_multiple(360.0, self.phi_step):
+            raise ValueError("phi_step must divide 360")
+        if not _is_multiple(self.phi_start, self.phi_step):
+            raise ValueError("phi_start must be a multiple of phi_step")
+        if self.settle < 0 or self.end_dwell < 0:
+            raise ValueError("Dwell times must not be negative")
+        
+        if not isinstance(self.adaptive, bool):
+            raise ValueError("adaptive must be true or false")
+        if self.adaptive:
+            if self.refine_step <= 0 or not _is_multiple(360.0, self.refine_step):
+                raise ValueError("refine_step must be positive and divide 360")
+            if not (_is_multiple(self.theta_step, self.refine_step) and
+                    _is_multiple(self.phi_step, self.refine_step)):
+                raise ValueError("theta_step and phi_step must be multiples of refine_step")
+            if self.refine_threshold <= 0:
+                raise ValueError("refine_threshold must be positive")
+    
+    @classmethod
+    def from_dict(cls, data: dict) -> 'ScanPlan':
+        """
+        Create a plan from a dictionary (e.g. a JSON request body).
+        
+        Missing keys take the defaults from config.py.
+        
+        Raises:
+            ValueError: If a key is unknown or a value is invalid
+        """
+        known = {field.name for field in fields(cls)}
+        unknown = set(data) - known
+        if unknown:
+            raise ValueError(f"Unknown scan plan parameter(s): {', '.join(sorted(unknown))}")
+        try:
+            return cls(**data)
+        except TypeError as e:
+            raise ValueError(str(e))
+    
+    def to_dict(self) -> dict:
+        """Convert to dictionary for JSON serialization."""
+        return asdict(self)
+    
+    @property
+    def full_circle(self) -> bool:
+        """Check if the azimuth window covers the whole circle."""
+        return self.phi_end - self.phi_start >= 360 - _EPSILON
+    
+    def servo_angles(self) -> List[float]:
+        """Get the servo angles of the grid, in ascending order."""
+        count = int(math.floor((self.theta_end - self.theta_start) / self.theta_step + _EPSILON)) + 1
+        return [round(self.theta_start + i * self.theta_step, 6) for i in range(count)]
+    
+    def stepper_angles(self) -> List[float]:
+        """Get the stepper angles of the grid (0-360), in window order."""
+        span = self.phi_end - self.phi_start
+        if self.full_circle:
+            count = int(math.floor(360.0 / self.phi_step - _EPSILON)) + 1
+        else:
+            count = int(math.floor(span / self.phi_step + _EPSILON)) + 1
+        return [round((self.phi_start + i * self.phi_step) % 360, 6) for i in range(count)]
+    
+    def fine_plan(self) -> 'ScanPlan':
+        """
+        Get the window of an adaptive plan at its refine step.
+        
+        Returns:
+            Non-adaptive plan over the same window at refine_step
+        """
+        return replace(self, theta_step=self.refine_step, phi_step=self.refine_step,
+                       adaptive=False)
+    
+    def coverage(self) -> Tuple[AxisCoverage, AxisCoverage]:
+        """
+        Get empty coverage trackers for the plan's window.
+        
+        Returns:
+            Tuple of (servo AxisCoverage, stepper AxisCoverage)
+        """
+        thetas = self.servo_angles()
+        phis = self.stepper_angles()
+        phi_span = 360.0 if self.full_circle else (len(phis) - 1) * self.phi_step
+        return (AxisCoverage(self.theta_start, thetas[-1] - self.theta_start, False),
+                AxisCoverage(self.phi_start, phi_span, self.full_circle))
+    
+    def grid(self) -> dict:
+        """
+        Get the organized grid of the plan.
+        
+        Returns:
+            Keyword arguments for RangeImage and DirectionTable
+        """
+        if self.adaptive:
+            return self.fine_plan().grid()
+        return {
+            'theta_start': self.theta_start,
+            'theta_end': self.servo_angles()[-1],
+            'theta_step': self.theta_step,
+            'phi_total': 360.0,
+            'phi_step': self.phi_step
+        }
+    
+    def compile(self) -> MotionSchedule:
+        """
+        Compile the plan into a motion schedule.
+        
+        For an adaptive plan this is the coarse survey only.
+        
+        Returns:
+            MotionSchedule with one row per sweep (or stepper pass)
+        """
+        thetas = self.servo_angles()
+        phis = self.stepper_angles()
+        rows: List[ScanRow] = []
+        
+        def row(axis: str, cycle: int, targets) -> ScanRow:
+            # The first move of a row may be long (a reversal or a return)
+            steps = [MotionStep(servo, stepper, self.end_dwell if i == 0 else self.settle)
+                     for i, (servo, stepper) in enumerate(targets)]
+            return ScanRow(axis, cycle, steps)
+        
+        if self.order == 'spiral':
+            for cycle, theta in enumerate(thetas):
+                rows.append(row('stepper', cycle, [(theta, phi) for phi in phis]))
+            return MotionSchedule(rows, len(thetas))
+        
+        if self.order == 'progressive':
+            phis = [phis[i] for i in progressive_order(len(phis))]
+        
+        for cycle, phi in enumerate(phis):
+            forward = [(theta, phi) for theta in thetas]
+            if self.order == 'raster':
+                rows.append(row('servo', cycle, forward))
+                rows.append(row('servo', cycle, forward[::-1]))
+            elif cycle % 2 == 0:
+                rows.append(row('servo', cycle, forward))
+            else:
+                rows.append(row('servo', cycle, forward[::-1]))
+        return MotionSchedule(rows, len(phis))
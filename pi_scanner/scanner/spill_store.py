@@ -0,0 +1,129 @@
+"""
+Append-only memory-mapped column files for scans larger than the RAM budget.
+
+A spilling PointCloud appends every point to one raw file per column. The
+files are never rewritten, so any range of points already written can be
+mapped read-only and handed out as a numpy array without copying it into
+memory; the kernel pages data in and out as it is read.
+"""
+
+import logging
+import os
+import weakref
+from datetime import datetime
+from typing import Dict, List
+import numpy as np
+
+from .point_encoding import ENCODED_COLUMNS
+from ..config import EXPORT_DIRECTORY, EXPORT_TIMESTAMP_FORMAT
+
+logger = logging.getLogger(__name__)
+
+# Column name -> (dtype, per-point shape); the encoded PointCloud columns
+COLUMNS = {name: (dtype, ()) for name, dtype in ENCODED_COLUMNS.items()}
+
+
+def _remove_files(files: list, paths: List[str]):
+    """Close and delete spill files (runs once, from close() or at collection)."""
+    for f in files:
+        try:
+            f.close()
+        except OSError:
+            pass
+    for path in paths:
+        try:
+            os.remove(path)
+        except OSError:
+            pass
+
+
+class SpillStore:
+    """
+    Set of append-only column files holding points [start_seq, end_seq).
+    
+    Only the PointCloud writer appends. Readers map ranges below the
+    end_seq they were published with. The files are deleted when the store
+    is closed or, if snapshots still refer to it, once the last of them is
+    released.
+    """
+    
+    def __init__(self, start_seq: int, directory: str = EXPORT_DIRECTORY):
+        """
+        Create the column files.
+        
+        Args:
+            start_seq: Sequence number of the first point to be appended
+            directory: Directory for the files (created if needed)
+        
+        Raises:
+            OSError: If the files cannot be created
+        """
+        os.makedirs(directory, exist_ok=True)
+        timestamp = datetime.now().strftime(EXPORT_TIMESTAMP_FORMAT)
+        base = os.path.join(directory, f"spill_{timestamp}_{start_seq}")
+        
+        self.start_seq = start_seq
+        self.end_seq = start_seq
+        self._paths: Dict[str, str] = {}
+        self._files = {}
+        try:
+            for name in COLUMNS:
+                path = f"{base}.{name}"
+                # Unbuffered, so appended bytes are visible to mmap readers at once
+                self._files[name] = open(path, 'wb', buffering=0)
+                self._paths[name] = path
+        except OSError:
+            _remove_files(list(self._files.values()), list(self._paths.values()))
+            raise
+        self._finalizer = weakref.finalize(
+            self, _remove_files, list(self._files.values()), list(self._paths.values()))
+        
+        logger.info(f"Spilling point cloud to {base}.*")
+    
+    def append(self, columns: Dict[str, np.ndarray]) -> bool:
+        """
+        Append points to the column files (writer only).
+        
+        Args:
+            columns: Arrays keyed by column name, all of the same length
+        
+        Returns:
+            True if all columns were written
+        """
+        n = len(columns['distance'])
+        try:
+            for name, (dtype, _shape) in COLUMNS.items():
+                data = np.ascontiguousarray(columns[name], dtype=dtype)
+                view = memoryview(data).cast('B')
+                while view:
+                    written = self._files[name].write(view)
+                    view = view[written:]
+        except (OSError, ValueError) as e:
+            logger.error(f"Failed to spill points to disk: {e}")
+            return False
+        self.end_seq += n
+        return True
+    
+    def view(self, name: str, start: int, end: int) -> np.ndarray:
+        """
+        Map a range of a column read-only.
+        
+        Args:
+            name: Column name
+            start: First sequence number
+            end: Sequence number after the last point (at most end_seq)
+        
+        Returns:
+            Read-only array of shape (end - start,) + column shape
+        """
+        dtype, shape = COLUMNS[name]
+        if end <= start:
+            return np.empty((0,) + shape, dtype=dtype)
+        itemsize = np.dtype(dtype).itemsize * int(np.prod(shape))
+        return np.memmap(self._paths[name], dtype=dtype, mode='r',
+                         offset=(start - self.start_seq) * itemsize,
+                         shape=(end - start,) + shape)
+    
+    def close(self):
+        """Close and delete the column files now, even if snapshots still map them."""
+        self._finalizer()
@@ -0,0 +1,8 @@
+"""
+Simulated environment for scans without hardware.
+"""
+
+from .scene import Scene, Room, Box, Sphere, Cylinder, Mesh, load_scene
+from .sensor_model import VL53L1XNoise
+
+__all__ = ['Scene', 'Room', 'Box', 'Sphere', 'Cylinder', 'Mesh', 'load_scene', 'VL53L1XNoise']
@@ -0,0 +1,152 @@
+"""
+Triangle mesh loading from PLY files for simulated scenes.
+
+Reads the vertex positions and faces of ASCII and binary PLY files (e.g.
+exported from Blender or MeshLab). Polygons are split into triangle fans;
+all other properties are skipped.
+"""
+
+import logging
+from typing import List, Tuple
+import numpy as np
+
+logger = logging.getLogger(__name__)
+
+# PLY scalar type names -> numpy type codes (without byte order)
+PLY_TYPES = {
+    'char': 'i1', 'int8': 'i1',
+    'uchar': 'u1', 'uint8': 'u1',
+    'short': 'i2', 'int16': 'i2',
+    'ushort': 'u2', 'uint16': 'u2',
+    'int': 'i4', 'int32': 'i4',
+    'uint': 'u4', 'uint32': 'u4',
+    'float': 'f4', 'float32': 'f4',
+    'double': 'f8', 'float64': 'f8'
+}
+
+# Byte order of each binary PLY format
+PLY_BYTE_ORDER = {
+    'binary_little_endian': '<',
+    'binary_big_endian': '>'
+}
+
+
+def _parse_header(f) -> Tuple[str, List[dict]]:
+    """
+    Read the PLY header.
+    
+    Returns:
+        Tuple of (format name, elements), each element a dict with name,
+        count and properties (name, type, list count type or None)
+    
+    Raises:
+        ValueError: If the file is not a valid PLY file
+    """
+    if f.readline().strip() != b'ply':
+        raise ValueError("Not a PLY file")
+    
+    file_format = None
+    elements: List[dict] = []
+    while True:
+        line = f.readline()
+        if not line:
+            raise ValueError("Unexpected end of PLY header")
+        words = line.decode('ascii', errors='replace').split()
+        if not words or words[0] in ('comment', 'obj_info'):
+            continue
+        if words[0] == 'end_header':
+            break
+        if words[0] == 'format':
+            file_format = words[1]
+        elif words[0] == 'element':
+            elements.append({'name': words[1], 'count': int(words[2]), 'properties': []})
+        elif words[0] == 'property':
+            if words[1] == 'list':
+                elements[-1]['properties'].append((words[4], PLY_TYPES[words[3]], PLY_TYPES[words[2]]))
+            else:
+                elements[-1]['properties'].append((words[2], PLY_TYPES[words[1]], None))
+    
+    if file_format not in ('ascii',) + tuple(PLY_BYTE_ORDER):
+        raise ValueError(f"Unsupported PLY format: {file_format}")
+    return file_format, elements
+
+
+def _triangulate(polygons: List[np.ndarray]) -> np.ndarray:
+    """Split polygons (vertex index arrays) into triangle fans."""
+    triangles = [np.stack([np.full(len(p) - 2, p[0]), p[1:-1], p[2:]], axis=1)
+                 for p in polygons if len(p) >= 3]
+    if not triangles:
+        return np.empty((0, 3), dtype=np.int64)
+    return np.concatenate(triangles).astype(np.int64)
+
+
+def _read_ascii(f, elements: List[dict]) -> Tuple[np.ndarray, np.ndarray]:
+    """Read the vertices and faces of an ASCII PLY body."""
+    vertices = None
+    polygons: List[np.ndarray] = []
+    for element in elements:
+        names = [name for name, _type, _count in element['properties']]
+        rows = [f.readline().split() for _ in range(element['count'])]
+        if element['name'] == 'vertex':
+            columns = [names.index(axis) for axis in ('x', 'y', 'z')]
+            vertices = np.array([[float(row[i]) for i in columns] for row in rows], dtype=np.float64)
+        elif element['name'] == 'face':
+            # Faces are expected to hold only their vertex index list
+            polygons = [np.array(row[1:1 + int(row[0])], dtype=np.int64) for row in rows]
+    return vertices, _triangulate(polygons)
+
+
+def _read_binary(f, elements: List[dict], order: str) -> Tuple[np.ndarray, np.ndarray]:
+    """Read the vertices and faces of a binary PLY body."""
+    vertices = None
+    triangles = np.empty((0, 3), dtype=np.int64)
+    for element in elements:
+        properties = element['properties']
+        if all(count is None for _name, _type, count in properties):
+            dtype = np.dtype([(name, order + ptype) for name, ptype, _count in properties])
+            data = np.frombuffer(f.read(dtype.itemsize * element['count']), dtype=dtype)
+            if element['name'] == 'vertex':
+                vertices = np.stack([data['x'], data['y'], data['z']], axis=1).astype(np.float64)
+            continue
+        
+        if element['name'] != 'face' or len(properties) != 1:
+            raise ValueError(f"Unsupported list properties in PLY element '{element['name']}'")
+        _name, index_type, count_type = properties[0]
+        count_dtype = np.dtype(order + count_type)
+        index_dtype = np.dtype(order + index_type)
+        polygons = []
+        for _ in range(element['count']):
+            n = int(np.frombuffer(f.read(count_dtype.itemsize), dtype=count_dtype)[0])
+            polygons.append(np.frombuffer(f.read(index_dtype.itemsize * n), dtype=index_dtype))
+        triangles = _triangulate(polygons)
+    return vertices, triangles
+
+
+def read_ply_mesh(filepath: str) -> Tuple[np.ndarray, np.ndarray]:
+    """
+    Read a triangle mesh from a PLY file.
+    
+    Args:
+        filepath: Path to the PLY file
+    
+    Returns:
+        Tuple of (vertices (V, 3) float64, triangles (F, 3) vertex indices)
+    
+    Raises:
+        OSError: If the file cannot be read
+        ValueError: If the file is not a PLY mesh
+    """
+    with open(filepath, 'rb') as f:
+        file_format, elements = _parse_header(f)
+        if file_format == 'ascii':
+            vertices, triangles = _read_ascii(f, elements)
+        else:
+            vertices, triangles = _read_binary(f, elements, PLY_BYTE_ORDER[file_format])
+    
+    if vertices is None or len(triangles) == 0:
+        raise ValueError(f"No triangle mesh in {filepath}")
+    if triangles.max() >= len(vertices):
+        raise ValueError(f"Face refers to a missing vertex in {filepath}")
+    
+    logger.info(f"Loaded mesh {filepath}: {len(vertices)} vertices, {len(triangles)} triangles")
+    return vertices, triangles
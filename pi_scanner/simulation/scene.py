@@ -0,0 +1,403 @@
+"""
+Geometric scenes for simulated scans.
+
+A scene is a set of primitives (room walls, boxes, spheres, cylinders and
+triangle meshes) in the scanner frame: millimetres, scanner at the origin,
+z up. Rays are cast against all of them at once with numpy, so a whole
+sweep is measured in a few array operations per primitive and stress tests
+can generate millions of readings per second.
+"""
+
+import logging
+from typing import List, Optional, Sequence, Tuple
+import numpy as np
+
+from .sensor_model import VL53L1XNoise
+from .ply_reader import read_ply_mesh
+from ..scanner.direction_table import KinematicModel
+from ..config import SIMULATION_SEED
+
+logger = logging.getLogger(__name__)
+
+# Rays measured per chunk of a sweep
+SWEEP_CHUNK = 65536
+
+# Ray-triangle pairs tested per chunk of a mesh intersection
+MESH_CHUNK = 1 << 20
+
+# Radius of the 'sphere' scene in mm
+SPHERE_SCENE_RADIUS = 500.0
+
+# Stand-in for zero direction components in slab tests
+EPSILON = 1e-12
+
+
+def _slabs(origins: np.ndarray, directions: np.ndarray,
+           minimum: np.ndarray, maximum: np.ndarray) -> Tuple[np.ndarray, np.ndarray]:
+    """
+    Intersect rays with the slabs of an axis-aligned box.
+    
+    Returns:
+        Tuple of (entry, exit) distances along each ray; the ray crosses
+        the box if entry <= exit
+    """
+    safe = np.where(directions == 0.0, EPSILON, directions)
+    t1 = (minimum - origins) / safe
+    t2 = (maximum - origins) / safe
+    return np.minimum(t1, t2).max(axis=1), np.maximum(t1, t2).min(axis=1)
+
+
+class Primitive:
+    """
+    Base class of scene geometry.
+    
+    Subclasses implement intersect(); reflectivity (0-1] sets the signal
+    strength of returns from the surface.
+    """
+    
+    reflectivity = 0.5
+    
+    def intersect(self, origins: np.ndarray, directions: np.ndarray) -> np.ndarray:
+        """
+        Intersect rays with the primitive.
+        
+        Args:
+            origins: Ray origins (N, 3) in mm
+            directions: Unit ray directions (N, 3)
+        
+        Returns:
+            Distance (N,) to the first hit in front of each origin; inf if none
+        """
+        raise NotImplementedError
+
+
+class Room(Primitive):
+    """Walls, floor and ceiling of a box, seen from inside."""
+    
+    def __init__(self, minimum: Sequence[float], maximum: Sequence[float],
+                 reflectivity: float = 0.85):
+        """
+        Args:
+            minimum: Corner with the smallest x, y, z in mm
+            maximum: Corner with the largest x, y, z in mm
+            reflectivity: Reflectivity of the surfaces
+        """
+        self.minimum = np.asarray(minimum, dtype=np.float64)
+        self.maximum = np.asarray(maximum, dtype=np.float64)
+        self.reflectivity = reflectivity
+    
+    def intersect(self, origins: np.ndarray, directions: np.ndarray) -> np.ndarray:
+        entry, exit_ = _slabs(origins, directions, self.minimum, self.maximum)
+        return np.where((exit_ >= np.maximum(entry, 0.0)) & (exit_ > 0.0), exit_, np.inf)
+
+
+class Box(Primitive):
+    """Solid axis-aligned box (furniture)."""
+    
+    def __init__(self, minimum: Sequence[float], maximum: Sequence[float],
+                 reflectivity: float = 0.5):
+        """
+        Args:
+            minimum: Corner with the smallest x, y, z in mm
+            maximum: Corner with the largest x, y, z in mm
+            reflectivity: Reflectivity of the surfaces
+        """
+        self.minimum = np.asarray(minimum, dtype=np.float64)
+        self.maximum = np.asarray(maximum, dtype=np.float64)
+        self.reflectivity = reflectivity
+    
+    def intersect(self, origins: np.ndarray, directions: np.ndarray) -> np.ndarray:
+        entry, exit_ = _slabs(origins, directions, self.minimum, self.maximum)
+        return np.where((entry <= exit_) & (entry > 0.0), entry, np.inf)
+
+
+class Sphere(Primitive):
+    """Sphere; seen from outside or (as a dome) from inside."""
+    
+    def __init__(self, centre: Sequence[float], radius: float, reflectivity: float = 0.5):
+        """
+        Args:
+            centre: Centre in mm
+            radius: Radius in mm
+            reflectivity: Reflectivity of the surface
+        """
+        self.centre = np.asarray(centre, dtype=np.float64)
+        self.radius = float(radius)
+        self.reflectivity = reflectivity
+    
+    def intersect(self, origins: np.ndarray, directions: np.ndarray) -> np.ndarray:
+        offset = origins - self.centre
+        b = np.einsum('ij,ij->i', offset, directions)
+        c = np.einsum('ij,ij->i', offset, offset) - self.radius ** 2
+        discriminant = b * b - c
+        root = np.sqrt(np.maximum(discriminant, 0.0))
+        near = -b - root
+        far = -b + root
+        t = np.where(near > 0.0, near, far)
+        return np.where((discriminant >= 0.0) & (t > 0.0), t, np.inf)
+
+
+class Cylinder(Primitive):
+    """Solid vertical cylinder with flat caps (pillars, bins, lamp stands)."""
+    
+    def __init__(self, centre: Sequence[float], radius: float, z_min: float, z_max: float,
+                 reflectivity: float = 0.5):
+        """
+        Args:
+            centre: Axis position (x, y) in mm
+            radius: Radius in mm
+            z_min: Height of the bottom cap in mm
+            z_max: Height of the top cap in mm
+            reflectivity: Reflectivity of the surfaces
+        """
+        self.centre = np.asarray(centre, dtype=np.float64)[:2]
+        self.radius = float(radius)
+        self.z_min = float(z_min)
+        self.z_max = float(z_max)
+        self.reflectivity = reflectivity
+    
+    def intersect(self, origins: np.ndarray, directions: np.ndarray) -> np.ndarray:
+        offset = origins[:, :2] - self.centre
+        dxy = directions[:, :2]
+        a = np.einsum('ij,ij->i', dxy, dxy)
+        b = np.einsum('ij,ij->i', offset, dxy)
+        c = np.einsum('ij,ij->i', offset, offset) - self.radius ** 2
+        
+        with np.errstate(divide='ignore', invalid='ignore'):
+            # Side: entry through the curved surface within the height
+            discriminant = b * b - a * c
+            side = (-b - np.sqrt(np.maximum(discriminant, 0.0))) / a
+            z = origins[:, 2] + side * directions[:, 2]
+            side = np.where((discriminant >= 0.0) & (a > 0.0) & (side > 0.0)
+                            & (z >= self.z_min) & (z <= self.z_max), side, np.inf)
+            
+            # Caps: the plane facing the ray, within the radius
+            dz = np.where(directions[:, 2] == 0.0, EPSILON, directions[:, 2])
+            plane = np.where(dz > 0.0, self.z_min, self.z_max)
+            cap = (plane - origins[:, 2]) / dz
+            radial = offset + cap[:, None] * dxy
+            inside = np.einsum('ij,ij->i', radial, radial) <= self.radius ** 2
+            cap = np.where(inside & (cap > 0.0), cap, np.inf)
+        
+        return np.minimum(side, cap)
+
+
+class Mesh(Primitive):
+    """Triangle mesh, intersected with the Moller-Trumbore test."""
+    
+    def __init__(self, vertices: np.ndarray, triangles: np.ndarray, reflectivity: float = 0.5):
+        """
+        Args:
+            vertices: Vertex positions (V, 3) in mm
+            triangles: Vertex indices (F, 3) of each triangle
+            reflectivity: Reflectivity of the surface
+        """
+        vertices = np.asarray(vertices, dtype=np.float64)
+        triangles = np.asarray(triangles, dtype=np.int64)
+        self.v0 = vertices[triangles[:, 0]]
+        self.edge1 = vertices[triangles[:, 1]] - self.v0
+        self.edge2 = vertices[triangles[:, 2]] - self.v0
+        self.minimum = vertices.min(axis=0)
+        self.maximum = vertices.max(axis=0)
+        self.reflectivity = reflectivity
+    
+    @classmethod
+    def from_ply(cls, filepath: str, scale: float = 1.0,
+                 offset: Sequence[float] = (0.0, 0.0, 0.0),
+                 reflectivity: float = 0.5) -> 'Mesh':
+        """
+        Load a mesh from a PLY file.
+        
+        Args:
+            filepath: Path to the PLY file
+            scale: Factor from file units to mm
+            offset: Translation applied after scaling, in mm
+            reflectivity: Reflectivity of the surface
+        
+        Returns:
+            Mesh in the scanner frame
+        """
+        vertices, triangles = read_ply_mesh(filepath)
+        return cls(vertices * scale + np.asarray(offset, dtype=np.float64), triangles, reflectivity)
+    
+    @property
+    def triangle_count(self) -> int:
+        """Get the number of triangles."""
+        return len(self.v0)
+    
+    def intersect(self, origins: np.ndarray, directions: np.ndarray) -> np.ndarray:
+        distances = np.full(len(origins), np.inf)
+        
+        # Only rays that cross the bounding box can hit a triangle
+        entry, exit_ = _slabs(origins, directions, self.minimum, self.maximum)
+        candidates = np.flatnonzero((entry <= exit_) & (exit_ > 0.0))
+        
+        rays_per_chunk = max(1, MESH_CHUNK // max(1, self.triangle_count))
+        for start in range(0, len(candidates), rays_per_chunk):
+            index = candidates[start:start + rays_per_chunk]
+            distances[index] = self._intersect_chunk(origins[index], directions[index])
+        return distances
+    
+    def _intersect_chunk(self, origins: np.ndarray, directions: np.ndarray) -> np.ndarray:
+        """Intersect a chunk of rays with every triangle (rays x triangles arrays)."""
+        p = np.cross(directions[:, None, :], self.edge2[None, :, :])
+        determinant = np.einsum('fk,nfk->nf', self.edge1, p)
+        with np.errstate(divide='ignore', invalid='ignore'):
+            inverse = 1.0 / determinant
+            s = origins[:, None, :] - self.v0[None, :, :]
+            u = np.einsum('nfk,nfk->nf', s, p) * inverse
+            q = np.cross(s, self.edge1[None, :, :])
+            v = np.einsum('nk,nfk->nf', directions, q) * inverse
+            t = np.einsum('fk,nfk->nf', self.edge2, q) * inverse
+        hit = ((np.abs(determinant) > EPSILON) & (u >= 0.0) & (v >= 0.0)
+               & (u + v <= 1.0) & (t > 0.0))
+        return np.where(hit, t, np.inf).min(axis=1)
+
+
+class Scene:
+    """
+    Primitives in the scanner frame with a sensor noise model.
+    
+    cast() gives the true distance and surface of each ray, measure() the
+    readings the VL53L1X would return, and sweep() the readings of whole
+    sweeps from commanded servo/stepper angles.
+    """
+    
+    def __init__(self, primitives: List[Primitive], noise: Optional[VL53L1XNoise] = None,
+                 seed: Optional[int] = SIMULATION_SEED):
+        """
+        Initialize the scene.
+        
+        Args:
+            primitives: Scene geometry
+            noise: Sensor model (default: VL53L1XNoise())
+            seed: Seed of the noise generator (None = random)
+        """
+        self.primitives = list(primitives)
+        self.noise = noise if noise is not None else VL53L1XNoise()
+        self.rng = np.random.default_rng(seed)
+    
+    def cast(self, origins: np.ndarray, directions: np.ndarray) -> Tuple[np.ndarray, np.ndarray]:
+        """
+        Find the nearest surface along each ray.
+        
+        Args:
+            origins: Ray origins (N, 3) in mm
+            directions: Unit ray directions (N, 3)
+        
+        Returns:
+            Tuple of (distance (N,), inf where nothing was hit; reflectivity (N,))
+        """
+        distance = np.full(len(origins), np.inf)
+        reflectivity = np.zeros(len(origins))
+        for primitive in self.primitives:
+            t = primitive.intersect(origins, directions)
+            closer = t < distance
+            distance[closer] = t[closer]
+            reflectivity[closer] = primitive.reflectivity
+        return distance, reflectivity
+    
+    def measure(self, origins: np.ndarray, directions: np.ndarray,
+                rng: Optional[np.random.Generator] = None) -> np.ndarray:
+        """
+        Simulate sensor readings along rays.
+        
+        Args:
+            origins: Ray origins (..., 3) in mm
+            directions: Unit ray directions (..., 3)
+            rng: Random generator (default: the scene's)
+        
+        Returns:
+            Readings in mm of shape (...); NaN where the reading failed
+        """
+        directions = np.asarray(directions, dtype=np.float64)
+        shape = directions.shape[:-1]
+        origins = np.broadcast_to(np.asarray(origins, dtype=np.float64), directions.shape)
+        distance, reflectivity = self.cast(origins.reshape(-1, 3), directions.reshape(-1, 3))
+        readings = self.noise.apply(distance, reflectivity, rng if rng is not None else self.rng)
+        return readings.reshape(shape)
+    
+    def sweep(self, theta: np.ndarray, phi: np.ndarray,
+              model: Optional[KinematicModel] = None,
+              rng: Optional[np.random.Generator] = None) -> np.ndarray:
+        """
+        Simulate the readings of a sweep at commanded angles.
+        
+        Args:
+            theta: Servo angles in degrees (broadcastable with phi)
+            phi: Stepper angles in degrees
+            model: Kinematic model of the scanner head (default: ideal)
+            rng: Random generator (default: the scene's)
+        
+        Returns:
+            uint16 distances in mm of the broadcast shape; 0 where the
+            reading failed
+        """
+        model = model if model is not None else KinematicModel()
+        theta, phi = np.broadcast_arrays(np.asarray(theta, dtype=np.float64),
+                                         np.asarray(phi, dtype=np.float64))
+        flat_theta = theta.ravel()
+        flat_phi = phi.ravel()
+        
+        result = np.zeros(flat_theta.shape, dtype=np.uint16)
+        for start in range(0, len(flat_theta), SWEEP_CHUNK):
+            chunk = slice(start, start + SWEEP_CHUNK)
+            origins, directions = model.rays(flat_theta[chunk], flat_phi[chunk])
+            readings = self.measure(origins, directions, rng)
+            result[chunk] = np.where(np.isnan(readings), 0, np.rint(readings)).astype(np.uint16)
+        return result.reshape(theta.shape)
+    
+    @classmethod
+    def furnished_room(cls, **kwargs) -> 'Scene':
+        """
+        Create a furnished 5 x 4 x 2.6 m room.
+        
+        The scanner stands 1 m above the floor, off the room's centre, with
+        a table, sofa, cabinet, pillar, bin and ball around it.
+        
+        Args:
+            **kwargs: Passed to Scene()
+        
+        Returns:
+            The scene
+        """
+        return cls([
+            Room((-2000, -1500, -1000), (3000, 2500, 1600), reflectivity=0.85),
+            Box((-2000, -1500, -1000), (3000, 2500, -995), reflectivity=0.3),    # Floor covering
+            Box((600, -400, -1000), (1400, 400, -250), reflectivity=0.45),       # Table
+            Box((-1950, 800, -1000), (-1100, 2400, -550), reflectivity=0.08),    # Sofa
+            Box((2550, -1450, -1000), (2950, -450, 900), reflectivity=0.6),      # Cabinet
+            Cylinder((-900, -900), 150, -1000, 1600, reflectivity=0.7),          # Pillar
+            Cylinder((1800, 1800), 200, -1000, -400, reflectivity=0.2),          # Bin
+            Sphere((1000, 0, -100), 150, reflectivity=0.9)                       # Ball on the table
+        ], **kwargs)
+    
+    @classmethod
+    def empty_room(cls, **kwargs) -> 'Scene':
+        """Create the room of furnished_room() without furniture."""
+        return cls([Room((-2000, -1500, -1000), (3000, 2500, 1600), reflectivity=0.85)], **kwargs)
+
+
+def load_scene(name: str) -> Optional[Scene]:
+    """
+    Create a scene by name.
+    
+    Args:
+        name: 'room', 'empty_room', 'sphere' or the path of a PLY mesh
+              (mm, scanner at the origin)
+    
+    Returns:
+        The scene, or None if it could not be loaded
+    """
+    if name == 'room':
+        return Scene.furnished_room()
+    if name == 'empty_room':
+        return Scene.empty_room()
+    if name == 'sphere':
+        return Scene([Sphere((0, 0, 0), SPHERE_SCENE_RADIUS)])
+    
+    try:
+        return Scene([Mesh.from_ply(name)])
+    except (OSError, ValueError, KeyError) as e:
+        logger.error(f"Failed to load simulation scene '{name}': {e}")
+        return None
@@ -0,0 +1,87 @@
+"""
+Measurement model of the VL53L1X for simulated readings.
+
+The sensor's returned signal falls with the square of the distance and
+with the reflectivity of the target. As it falls the ranging noise grows,
+and towards the range limit more and more readings fail altogether.
+"""
+
+import numpy as np
+
+from ..config import (
+    TOF_MIN_RANGE,
+    TOF_MAX_RANGE,
+    TOF_SIM_SIGMA_MIN,
+    TOF_SIM_SIGMA_1M,
+    TOF_SIM_DROPOUT
+)
+
+# Reflectivity of the datasheet's white target, at which TOF_MAX_RANGE applies
+WHITE_REFLECTIVITY = 0.88
+
+# Fraction of the range limit from which readings start to drop out
+DROPOUT_ONSET = 0.8
+
+
+class VL53L1XNoise:
+    """
+    Distance-dependent noise and dropouts of VL53L1X readings.
+    
+    For a target at distance d (mm) with reflectivity rho:
+    - sigma = sigma_min + sigma_1m * (d / 1000)^2 * (WHITE_REFLECTIVITY / rho)
+    - the range limit is max_range * sqrt(rho / WHITE_REFLECTIVITY); readings
+      drop out with a probability rising linearly from 0 at DROPOUT_ONSET
+      of the limit to 1 at the limit, plus a constant dropout rate
+    """
+    
+    def __init__(self,
+                 sigma_min: float = TOF_SIM_SIGMA_MIN,
+                 sigma_1m: float = TOF_SIM_SIGMA_1M,
+                 dropout: float = TOF_SIM_DROPOUT,
+                 min_range: float = TOF_MIN_RANGE,
+                 max_range: float = TOF_MAX_RANGE):
+        """
+        Initialize the model.
+        
+        Args:
+            sigma_min: Noise floor in mm (one sigma)
+            sigma_1m: Extra sigma at 1 m on a white target in mm
+            dropout: Fraction of readings lost regardless of signal
+            min_range: Shortest valid reading in mm
+            max_range: Range limit on a white target in mm
+        """
+        self.sigma_min = sigma_min
+        self.sigma_1m = sigma_1m
+        self.dropout = dropout
+        self.min_range = min_range
+        self.max_range = max_range
+    
+    def apply(self, distance: np.ndarray, reflectivity: np.ndarray,
+              rng: np.random.Generator) -> np.ndarray:
+        """
+        Turn true distances into simulated readings.
+        
+        Args:
+            distance: True distances in mm (inf where the ray hit nothing)
+            reflectivity: Reflectivity (0-1] of the surface hit by each ray
+            rng: Random generator
+        
+        Returns:
+            Float64 readings in mm; NaN where the reading failed
+        """
+        distance = np.asarray(distance, dtype=np.float64)
+        relative = WHITE_REFLECTIVITY / np.maximum(np.asarray(reflectivity, dtype=np.float64), 1e-3)
+        
+        with np.errstate(invalid='ignore', over='ignore'):
+            sigma = self.sigma_min + self.sigma_1m * (distance / 1000.0) ** 2 * relative
+            readings = distance + rng.standard_normal(distance.shape) * sigma
+            
+            # Signal-limited range, then random losses
+            limit = self.max_range / np.sqrt(relative)
+            onset = DROPOUT_ONSET * limit
+            lost = np.clip((distance - onset) / (limit - onset), 0.0, 1.0) + self.dropout
+            failed = ~np.isfinite(distance) | (rng.random(distance.shape) < lost)
+            failed |= (readings < self.min_range) | (readings > self.max_range)
+        
+        readings[failed] = np.nan
+        return readings
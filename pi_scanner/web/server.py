@@ -2,14 +2,17 @@
 Flask web server with WebSocket support for real-time point cloud visualization.
 """
 
+import json
 import logging
 import os
-from typing import Optional
+from typing import Iterator, Optional
 from flask import Flask, render_template, jsonify, request, send_file
 from flask_socketio import SocketIO, emit
 
 from ..scanner.coordinator import ScanCoordinator, ScanState
-from ..scanner.point_cloud import Point3D
+from ..scanner.point_cloud import PointBatch, CloudSnapshot
+from ..scanner.point_encoding import pack_columns
+from ..scanner.scan_plan import ScanPlan
 from ..export import PLYWriter, PCDWriter
 from ..config import WEB_HOST, WEB_PORT, WEB_DEBUG, EXPORT_DIRECTORY
 
@@ -72,17 +75,54 @@ def register_routes(app: Flask):
         progress = scanner.get_progress()
         return jsonify(progress.to_dict())
     
+    @app.route('/api/stats')
+    def get_stats():
+        """Get bounding box, centroid and per-axis statistics of the cloud."""
+        if scanner is None:
+            return jsonify({'error': 'Scanner not initialized'}), 500
+        
+        return jsonify(scanner.point_cloud.get_stats().to_dict())
+    
+    @app.route('/api/scan/timeline')
+    def get_timeline():
+        """
+        Get the per-stage acquisition timeline of the current scan.
+        
+        Query parameters:
+            recent: If 1, include the latest stage intervals
+        """
+        if scanner is None:
+            return jsonify({'error': 'Scanner not initialized'}), 500
+        
+        recent = request.args.get('recent', default=0, type=int) == 1
+        return jsonify(scanner.get_timeline(recent=recent))
+    
+    @app.route('/api/scan/latency')
+    def get_control_latency():
+        """Get the latency of pause/resume/stop commands (p50/p99/max in ms)."""
+        if scanner is None:
+            return jsonify({'error': 'Scanner not initialized'}), 500
+        
+        return jsonify(scanner.get_control_latency())
+    
     @app.route('/api/points')
     def get_points():
-        """Get all points in the current scan."""
+        """
+        Get points in the current scan.
+        
+        Query parameters:
+            since: Cursor from a previous response; only newer points are returned
+        """
         if scanner is None:
             return jsonify({'error': 'Scanner not initialized'}), 500
         
-        points = scanner.point_cloud.get_points_as_list()
-        return jsonify({
-            'count': len(points),
-            'points': points
-        })
+        since = request.args.get('since', type=int)
+        snapshot = scanner.point_cloud.snapshot()
+        if snapshot.resolve_cursor(since)[1]:
+            # Full responses are streamed a slice at a time
+            return app.response_class(points_json_stream(snapshot),
+                                      mimetype='application/json')
+        return jsonify(points_since_payload(since, snapshot))
     
     @app.route('/api/points/latest/<int:count>')
     def get_latest_points(count: int):
@@ -98,12 +138,38 @@ def register_routes(app: Flask):
     
     @app.route('/api/scan/start', methods=['POST'])
     def start_scan():
-        """Start a new scan."""
+        """
+        Start a new scan.
+        
+        Optional JSON body with ScanPlan parameters; omitted ones take the
+        config defaults, and an empty body repeats the previous plan:
+            theta_start, theta_end: Elevation (servo) window in degrees
+            phi_start, phi_end: Azimuth (stepper) window in degrees
+            theta_step, phi_step: Step sizes in degrees
+            order: 'raster', 'serpentine', 'spiral' or 'progressive'
+            settle, end_dwell: Dwell times in seconds
+            adaptive: Survey at the steps above, then refine depth edges
+            refine_step, refine_threshold: Fine step and edge threshold
+        """
         if scanner is None:
             return jsonify({'error': 'Scanner not initialized'}), 500
         
-        success = scanner.start_scan()
-        return jsonify({'success': success, 'state': scanner.get_state().value})
+        plan = None
+        params = request.get_json(silent=True)
+        if params:
+            if not isinstance(params, dict):
+                return jsonify({'success': False, 'error': 'Scan plan must be a JSON object'}), 400
+            try:
+                plan = ScanPlan.from_dict(params)
+            except ValueError as e:
+                return jsonify({'success': False, 'error': str(e)}), 400
+        
+        success = scanner.start_scan(plan)
+        return jsonify({
+            'success': success,
+            'state': scanner.get_state().value,
+            'plan': scanner.plan.to_dict()
+        })
     
     @app.route('/api/scan/stop', methods=['POST'])
     def stop_scan():
@@ -125,12 +191,32 @@ def register_routes(app: Flask):
     
     @app.route('/api/scan/resume', methods=['POST'])
     def resume_scan():
-        """Resume a paused scan."""
+        """
+        Resume a paused scan, or continue an interrupted one.
+        
+        While paused, the scan carries on. When idle and the request body
+        has "journal": true, the scan in the scan journal (e.g. cut short by
+        a crash or power loss) is rebuilt up to its last checkpoint and
+        continues from there; /api/status reports whether there is one.
+        """
         if scanner is None:
             return jsonify({'error': 'Scanner not initialized'}), 500
         
-        scanner.resume_scan()
-        return jsonify({'success': True, 'state': scanner.get_state().value})
+        if scanner.get_state() == ScanState.PAUSED:
+            scanner.resume_scan()
+            return jsonify({'success': True, 'state': scanner.get_state().value})
+        
+        data = request.get_json(silent=True) or {}
+        if not data.get('journal'):
+            return jsonify({'success': False, 'error': 'No paused scan',
+                            'state': scanner.get_state().value}), 400
+        
+        success = scanner.resume_from_journal()
+        return jsonify({
+            'success': success,
+            'state': scanner.get_state().value,
+            'plan': scanner.plan.to_dict()
+        })
     
     @app.route('/api/scan/reset', methods=['POST'])
     def reset_scan():
@@ -147,21 +233,11 @@ def register_routes(app: Flask):
         if scanner is None:
             return jsonify({'error': 'Scanner not initialized'}), 500
         
-        # Create export directory if needed
-        os.makedirs(EXPORT_DIRECTORY, exist_ok=True)
-        
-        # Generate filename
-        from datetime import datetime
-        from ..config import EXPORT_TIMESTAMP_FORMAT
-        timestamp = datetime.now().strftime(EXPORT_TIMESTAMP_FORMAT)
-        filename = f"scan_{timestamp}.ply"
-        filepath = os.path.join(EXPORT_DIRECTORY, filename)
+        filepath = export_snapshot(PLYWriter(), 'ply')
+        if filepath is None:
+            return jsonify({'error': 'Export failed'}), 500
         
-        # Export
-        writer = PLYWriter()
-        writer.write(scanner.point_cloud, filepath)
-        
-        return send_file(filepath, as_attachment=True, download_name=filename)
+        return send_file(filepath, as_attachment=True, download_name=os.path.basename(filepath))
     
     @app.route('/api/export/pcd', methods=['GET'])
     def export_pcd():
@@ -169,21 +245,138 @@ def register_routes(app: Flask):
         if scanner is None:
             return jsonify({'error': 'Scanner not initialized'}), 500
         
+        filepath = export_snapshot(PCDWriter(), 'pcd')
+        if filepath is None:
+            return jsonify({'error': 'Export failed'}), 500
+        
+        return send_file(filepath, as_attachment=True, download_name=os.path.basename(filepath))
+
+
+def export_snapshot(writer, extension: str) -> Optional[str]:
+    """
+    Export the current cloud, reusing the file if this version was already exported.
+    
+    Args:
+        writer: PLYWriter or PCDWriter
+        extension: File extension without the dot
+        
+    Returns:
+        Path of the exported file, or None if the export failed
+    """
+    from datetime import datetime
+    from ..config import EXPORT_TIMESTAMP_FORMAT
+    
+    def build(snapshot: CloudSnapshot) -> Optional[str]:
         # Create export directory if needed
         os.makedirs(EXPORT_DIRECTORY, exist_ok=True)
         
-        # Generate filename
-        from datetime import datetime
-        from ..config import EXPORT_TIMESTAMP_FORMAT
         timestamp = datetime.now().strftime(EXPORT_TIMESTAMP_FORMAT)
-        filename = f"scan_{timestamp}.pcd"
-        filepath = os.path.join(EXPORT_DIRECTORY, filename)
+        filepath = os.path.join(EXPORT_DIRECTORY, f"scan_{timestamp}.{extension}")
+        return filepath if writer.write(snapshot, filepath) else None
+    
+    snapshot = scanner.point_cloud.snapshot()
+    key = ('export', extension)
+    filepath = snapshot.cached(key, build)
+    if filepath is not None and not os.path.exists(filepath):
+        snapshot.discard(key)
+        filepath = snapshot.cached(key, build)
+    return filepath
+
+
+def points_since_payload(cursor: Optional[int],
+                         snapshot: Optional[CloudSnapshot] = None) -> dict:
+    """
+    Build a delta response for clients catching up from a cursor.
+    
+    Full responses (reset set) hold every point; /api/points streams those
+    with points_json_stream() instead.
+    
+    Args:
+        cursor: Cursor from the client's last response, or None for everything
+        snapshot: Snapshot to read from (default: the latest)
         
-        # Export
-        writer = PCDWriter()
-        writer.write(scanner.point_cloud, filepath)
+    Returns:
+        Dictionary with points, their starting sequence number, the next
+        cursor, the cloud version and a reset flag telling the client to
+        discard its copy
+    """
+    if snapshot is None:
+        snapshot = scanner.point_cloud.snapshot()
+    points, next_cursor, reset = snapshot.get_points_since(cursor)
+    return {
+        'count': len(points),
+        'points': points.tolist(),
+        'start': next_cursor - len(points),
+        'cursor': next_cursor,
+        'version': snapshot.version,
+        'reset': reset
+    }
+
+
+def points_json_stream(snapshot: CloudSnapshot) -> Iterator[str]:
+    """
+    Encode a full points response as JSON, a slice of points at a time.
+    
+    The response has the fields of points_since_payload() with reset set;
+    only one slice of expanded points is held in memory at a time.
+    
+    Args:
+        snapshot: Snapshot to read from
+        
+    Yields:
+        Consecutive pieces of the JSON document
+    """
+    yield f'{{"count": {len(snapshot)}, "points": ['
+    separator = ''
+    for columns in snapshot.iter_columns(('xyz',)):
+        points = json.dumps(columns['xyz'].tolist())[1:-1]
+        if points:
+            yield separator + points
+            separator = ', '
+    trailer = json.dumps({
+        'start': snapshot.first_seq,
+        'cursor': snapshot.next_seq,
+        'version': snapshot.version,
+        'reset': True
+    })
+    yield '], ' + trailer[1:]
+
+
+def encoded_points_payload(cursor: Optional[int],
+                           snapshot: Optional[CloudSnapshot] = None) -> dict:
+    """
+    Build a compact binary delta for Socket.IO clients.
+    
+    Points travel in the 7-byte encoding (see point_encoding.pack_columns)
+    together with the kinematic models the client needs to expand them.
+    
+    Args:
+        cursor: Cursor from the client's last message, or None for everything
+        snapshot: Snapshot to read from (default: the latest)
         
-        return send_file(filepath, as_attachment=True, download_name=filename)
+    Returns:
+        Dictionary with the packed points ('data'), their count, model
+        frames, starting sequence number, next cursor, version and reset flag
+    """
+    if snapshot is None:
+        snapshot = scanner.point_cloud.snapshot()
+    start, reset = snapshot.resolve_cursor(cursor)
+    
+    def build(_snapshot: CloudSnapshot) -> dict:
+        columns = snapshot.get_encoded(start)
+        return {
+            'count': len(columns['distance']),
+            'data': pack_columns(columns),
+            'frames': [[seq, model.to_dict()] for seq, model in snapshot.get_frames(start)],
+            'start': start,
+            'cursor': snapshot.next_seq,
+            'version': snapshot.version,
+            'reset': reset
+        }
+    
+    if reset:
+        return snapshot.cached('encoded_payload', build)
+    return build(snapshot)
 
 
 def register_socketio_handlers(sio: SocketIO):
@@ -194,15 +387,22 @@ def register_socketio_handlers(sio: SocketIO):
         """Handle client connection."""
         logger.info("Client connected")
         
-        # Send current state
+        # Send current state; points follow once the client sends 'resume'
         if scanner is not None:
             progress = scanner.get_progress()
             emit('status', progress.to_dict())
-            
-            # Send existing points if any
-            points = scanner.point_cloud.get_points_as_list()
-            if points:
-                emit('points_batch', {'points': points})
+    
+    @sio.on('resume')
+    def handle_resume(data=None):
+        """
+        Handle resume handshake from a (re)connecting client.
+        
+        The client sends the last cursor it received (or none on first load)
+        and gets back only the points it missed.
+        """
+        if scanner is not None:
+            cursor = (data or {}).get('cursor')
+            emit('points_batch', encoded_points_payload(cursor))
     
     @sio.on('disconnect')
     def handle_disconnect():
@@ -213,8 +413,7 @@ def register_socketio_handlers(sio: SocketIO):
     def handle_request_points():
         """Handle request for all points."""
         if scanner is not None:
-            points = scanner.point_cloud.get_points_as_list()
-            emit('points_batch', {'points': points})
+            emit('points_batch', encoded_points_payload(None))
     
     @sio.on('request_status')
     def handle_request_status():
@@ -229,10 +428,16 @@ def register_scanner_callbacks():
     if scanner is None or socketio is None:
         return
     
-    def on_points(points: list):
+    def on_points(batch: PointBatch):
         """Broadcast new points to all clients."""
-        point_list = [[p.x, p.y, p.z] for p in points]
-        socketio.emit('points', {'points': point_list})
+        # Sequence range lets clients drop duplicates and detect gaps
+        socketio.emit('points', {
+            'count': len(batch),
+            'data': pack_columns(batch.encoded()),
+            'frames': [[batch.start_seq, batch.model.to_dict()]],
+            'start': batch.start_seq,
+            'cursor': batch.end_seq
+        })
     
     def on_progress(progress):
         """Broadcast progress updates."""
@@ -240,7 +445,10 @@ def register_scanner_callbacks():
     
     def on_state_change(state: ScanState):
         """Broadcast state changes."""
-        socketio.emit('state', {'state': state.value})
+        socketio.emit('state', {
+            'state': state.value,
+            'resumable': state == ScanState.IDLE and scanner.resumable
+        })
     
     scanner.on_points(on_points)
     scanner.on_progress(on_progress)
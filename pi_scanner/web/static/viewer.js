@@ -15,6 +15,7 @@ class PointCloudViewer {
         this.pointSize = 3;
         this.axesHelper = null;
         this.gridHelper = null;
+        this.stats = null; // Server-side cloud statistics (bounds, mean, std)
         
         this.init();
         this.animate();
@@ -265,9 +266,23 @@ class PointCloudViewer {
         this.updateCamera();
     }
     
+    setStats(stats) {
+        this.stats = stats;
+    }
+    
     fitToPoints() {
         if (this.points.length === 0) return;
         
+        // Prefer the bounds the server already maintains
+        if (this.stats && this.stats.count > 0) {
+            const [minX, minY, minZ] = this.stats.min;
+            const [maxX, maxY, maxZ] = this.stats.max;
+            const size = Math.max(maxX - minX, maxY - minY, maxZ - minZ);
+            this.spherical.radius = size * 2;
+            this.updateCamera();
+            return;
+        }
+        
         // Calculate bounding box
         let minX = Infinity, maxX = -Infinity;
         let minY = Infinity, maxY = -Infinity;
@@ -308,6 +323,9 @@ class ScannerController {
         this.viewer = viewer;
         this.socket = null;
         this.state = 'idle';
+        this.cursor = null; // Sequence cursor of the next point we expect
+        this.resuming = false;
+        this.resumable = false; // The scan journal holds an interrupted scan
         
         this.initSocket();
         this.initUI();
@@ -320,6 +338,8 @@ class ScannerController {
             console.log('Connected to server');
             this.updateConnectionStatus(true);
             this.socket.emit('request_status');
+            // Only fetch the points we missed while disconnected
+            this.resume();
         });
         
         this.socket.on('disconnect', () => {
@@ -328,13 +348,24 @@ class ScannerController {
         });
         
         this.socket.on('points', (data) => {
-            this.viewer.addPoints(data.points);
-            this.updatePointCount(this.viewer.points.length);
+            // A pending resume reply already covers anything sent before it
+            if (this.resuming) return;
+            
+            if (data.start > this.cursor) {
+                // Missed a batch; catch up from our cursor
+                this.resume();
+                return;
+            }
+            this.appendPoints(data);
         });
         
         this.socket.on('points_batch', (data) => {
-            this.viewer.addPoints(data.points);
-            this.updatePointCount(this.viewer.points.length);
+            this.resuming = false;
+            if (data.reset) {
+                this.viewer.clearPoints();
+                this.cursor = data.start;
+            }
+            this.appendPoints(data);
         });
         
         this.socket.on('progress', (data) => {
@@ -343,14 +374,58 @@ class ScannerController {
         
         this.socket.on('status', (data) => {
             this.updateProgress(data);
-            this.updateState(data.state);
+            this.updateState(data.state, data.resumable);
         });
         
         this.socket.on('state', (data) => {
-            this.updateState(data.state);
+            this.updateState(data.state, data.resumable);
         });
     }
     
+    resume() {
+        this.resuming = true;
+        this.socket.emit('resume', { cursor: this.cursor });
+    }
+    
+    appendPoints(data) {
+        // Skip points we already have
+        const skip = Math.max(0, this.cursor - data.start);
+        if (skip < data.count) {
+            this.viewer.addPoints(this.decodePoints(data, skip));
+            this.cursor = data.cursor;
+        }
+        this.updatePointCount(this.viewer.points.length);
+    }
+    
+    decodePoints(data, skip) {
+        // Packed columns: uint16 distance (mm), servo and stepper angles
+        // (0.01 degree), then uint8 quality; see point_encoding.py
+        const n = data.count;
+        const buffer = new Uint8Array(data.data).slice().buffer; // Aligned copy
+        const distance = new Uint16Array(buffer, 0, n);
+        const servo = new Uint16Array(buffer, 2 * n, n);
+        const stepper = new Uint16Array(buffer, 4 * n, n);
+        
+        const points = [];
+        let frame = 0;
+        for (let i = skip; i < n; i++) {
+            while (frame + 1 < data.frames.length && data.start + i >= data.frames[frame + 1][0]) {
+                frame++;
+            }
+            const model = data.frames[frame][1];
+            
+            // Same ray model as KinematicModel.rays() on the server
+            const theta = (servo[i] / 100 * model.theta_scale + model.theta_offset) * Math.PI / 180;
+            const phi = (stepper[i] / 100 + model.phi_offset) * Math.PI / 180;
+            const dx = Math.sin(theta) * Math.cos(phi);
+            const dy = Math.sin(theta) * Math.sin(phi);
+            const dz = Math.cos(theta);
+            const r = distance[i] + model.sensor_offset_mm;
+            points.push([dx * r, dy * r, dz * r + model.axis_height_mm]);
+        }
+        return points;
+    }
+    
     initUI() {
         // Scan controls
         document.getElementById('btn-start').addEventListener('click', () => this.startScan());
@@ -422,7 +497,12 @@ class ScannerController {
     
     async resumeScan() {
         try {
-            const response = await fetch('/api/scan/resume', { method: 'POST' });
+            // When idle, continue the interrupted scan in the journal
+            const response = await fetch('/api/scan/resume', {
+                method: 'POST',
+                headers: { 'Content-Type': 'application/json' },
+                body: JSON.stringify({ journal: this.state === 'idle' })
+            });
             const data = await response.json();
             console.log('Resume scan response:', data);
         } catch (error) {
@@ -436,6 +516,7 @@ class ScannerController {
             const data = await response.json();
             this.viewer.clearPoints();
             this.updatePointCount(0);
+            this.updateState(data.state, false);
             console.log('Reset scan response:', data);
         } catch (error) {
             console.error('Error resetting scan:', error);
@@ -458,8 +539,11 @@ class ScannerController {
         }
     }
     
-    updateState(state) {
+    updateState(state, resumable) {
         this.state = state;
+        if (resumable !== undefined) {
+            this.resumable = resumable;
+        }
         
         const statusDot = document.getElementById('status-dot');
         const statusText = document.getElementById('status-text');
@@ -477,7 +561,7 @@ class ScannerController {
                 btnStart.disabled = false;
                 btnStop.disabled = true;
                 btnPause.disabled = true;
-                btnResume.disabled = true;
+                btnResume.disabled = !this.resumable;  // Continues an interrupted scan from its journal
                 break;
             case 'scanning':
                 statusText.textContent = 'Scanning...';
@@ -513,6 +597,10 @@ class ScannerController {
     }
     
     updateProgress(data) {
+        if (data.stats) {
+            this.viewer.setStats(data.stats);
+        }
+        
         document.getElementById('servo-angle').textContent = `${Math.round(data.servo_angle)}°`;
         document.getElementById('stepper-angle').textContent = `${Math.round(data.stepper_angle)}°`;
         document.getElementById('point-count').textContent = data.points_collected.toLocaleString();
@@ -524,6 +612,9 @@ class ScannerController {
         let progressText = 'Ready to scan';
         if (data.state === 'scanning') {
             progressText = `Scanning: Cycle ${data.current_cycle} of ${data.total_cycles}`;
+            if (data.phi_resolution != null) {
+                progressText += ` (resolution ${Math.round(data.phi_resolution * 10) / 10}°)`;
+            }
         } else if (data.state === 'paused') {
             progressText = 'Scan paused';
         } else if (progress >= 100) {